@@ -4,6 +4,16 @@
 #include <string>
 #include <map>
 #include <regex>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <random>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -130,9 +140,240 @@ void printTokens(const vector<Token>& tokens) {
     }
 }
 
+// Runtime I/O for Read and Print. Both sides move whole blocks through
+// stdio; integers are parsed and formatted eight digits at a time.
+// Output goes out when its buffer fills, when Read needs more input
+// (so prompts are visible), on flush() and at exit.
+
+struct OutputBuffer;
+void flushBeforeRead();
+
+// Number of leading ASCII digits in p[0..16), using one SSE2 compare
+inline int digitRun16(const char* p) {
+#if defined(__SSE2__)
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    // c - '0' lands in [0, 9] for digits; shift into signed range to compare
+    __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('0' + 128));
+    __m128i isDigit = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 10));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(isDigit));
+    return __builtin_ctz(~mask | 0x10000u);
+#else
+    int n = 0;
+    while (n < 16 && isdigit(static_cast<unsigned char>(p[n]))) n++;
+    return n;
+#endif
+}
+
+// Eight ASCII digits to their value with three multiplies (SWAR)
+inline uint64_t parseEightDigits(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    v = (v & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    v = (v & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32;
+}
+
+// Value below 10^8 to eight ASCII digits, most significant byte first in
+// memory; returns the digits before the ASCII bias so callers can count
+// leading zeros
+inline uint64_t formatEightDigits(uint32_t value, char* out) {
+    uint64_t merged = (value / 10000) | (static_cast<uint64_t>(value % 10000) << 32);
+    uint64_t hundreds = ((merged * 10486) >> 20) & ((0x7FULL << 32) | 0x7FULL);
+    uint64_t pairs = ((merged - 100 * hundreds) << 16) + hundreds;
+    uint64_t tens = ((pairs * 103) >> 10) & 0x000F000F000F000FULL;
+    uint64_t digits = tens + ((pairs - 10 * tens) << 8);
+    uint64_t ascii = digits + 0x3030303030303030ULL;
+    memcpy(out, &ascii, 8);
+    return digits;
+}
+
+struct InputBuffer {
+    static const size_t blockSize = 1 << 16;
+    static const size_t slack = 64;  // a whole integer always fits, plus SIMD overread
+
+    FILE* file;
+    vector<char> buffer;
+    size_t pos = 0, len = 0;
+    bool eof = false, failed = false;
+
+    InputBuffer(FILE* file) : file(file), buffer(blockSize + slack, '\0') {}
+
+    // Keep at least `want` bytes ahead of pos unless the file has ended
+    void ensure(size_t want) {
+        if (len - pos >= want || eof) return;
+        flushBeforeRead();
+        memmove(buffer.data(), buffer.data() + pos, len - pos);
+        len -= pos;
+        pos = 0;
+        while (len < blockSize && !eof) {
+            size_t n = fread(buffer.data() + len, 1, blockSize - len, file);
+            if (n == 0) eof = true;
+            len += n;
+            if (len - pos >= want) break;
+        }
+        // Zeros after the data end every digit run
+        memset(buffer.data() + len, 0, slack);
+    }
+
+    // Same contract as `cin >> value` into a zeroed variable: false with 0
+    // on end of input or a malformed token, an out-of-range value is
+    // clamped, and after a failure every later read fails too
+    bool readInt(long long& value) {
+        value = 0;
+        if (failed) return false;
+        for (;;) {
+            ensure(1);
+            while (pos < len && isspace(static_cast<unsigned char>(buffer[pos]))) pos++;
+            if (pos < len || eof) break;
+        }
+        ensure(32);
+        // Offsets are relative to pos, which ensure() keeps in place
+        size_t sign = 0;
+        bool negative = false;
+        if (buffer[pos] == '-' || buffer[pos] == '+') {
+            negative = buffer[pos] == '-';
+            sign = 1;
+        }
+        size_t run = digitRun16(&buffer[pos + sign]);
+        if (run == 0) {
+            failed = true;
+            return false;
+        }
+        if (run == 16) {
+            // Leading zeros or an out-of-range value
+            for (;;) {
+                ensure(sign + run + 32);
+                size_t more = digitRun16(&buffer[pos + sign + run]);
+                run += more;
+                if (more < 16) break;
+            }
+        }
+        const char* digits = &buffer[pos + sign];
+        const char* end = digits + run;
+        while (digits + 1 < end && *digits == '0') digits++;
+        uint64_t magnitude = 0;
+        bool overflow = end - digits > 19;
+        if (!overflow) {
+            const char* p = digits;
+            for (; end - p >= 8; p += 8) magnitude = magnitude * 100000000 + parseEightDigits(p);
+            for (; p < end; ++p) magnitude = magnitude * 10 + static_cast<uint64_t>(*p - '0');
+            overflow = magnitude > (negative ? 9223372036854775808ULL : 9223372036854775807ULL);
+        }
+        pos += sign + run;
+        if (overflow) {
+            value = negative ? INT64_MIN : INT64_MAX;
+            failed = true;
+            return false;
+        }
+        value = negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+        return true;
+    }
+};
+
+struct OutputBuffer {
+    static const size_t blockSize = 1 << 16;
+
+    FILE* file;
+    vector<char> buffer;
+    size_t len = 0;
+
+    OutputBuffer(FILE* file) : file(file), buffer(blockSize) {}
+    ~OutputBuffer() { flush(); }
+
+    void flush() {
+        if (len > 0) fwrite(buffer.data(), 1, len, file);
+        fflush(file);
+        len = 0;
+    }
+
+    void reserve(size_t n) {
+        if (len + n > buffer.size()) {
+            flush();
+            if (n > buffer.size()) buffer.resize(n);
+        }
+    }
+
+    void writeString(const string& text) {
+        reserve(text.size());
+        memcpy(buffer.data() + len, text.data(), text.size());
+        len += text.size();
+    }
+
+    void writeChar(char c) {
+        reserve(1);
+        buffer[len++] = c;
+    }
+
+    void writeInt(long long value) {
+        reserve(24);
+        char* out = buffer.data() + len;
+        uint64_t magnitude = static_cast<uint64_t>(value);
+        if (value < 0) {
+            *out++ = '-';
+            magnitude = 0 - magnitude;
+        }
+        char scratch[8];
+        if (magnitude < 100000000) {
+            // Skip the leading zero bytes; zero itself keeps one digit
+            uint64_t digits = formatEightDigits(static_cast<uint32_t>(magnitude), scratch);
+            int skip = digits == 0 ? 7 : __builtin_ctzll(digits) / 8;
+            memcpy(out, scratch + skip, 8 - skip);
+            out += 8 - skip;
+        }
+        else {
+            uint64_t high = magnitude / 100000000;
+            if (high >= 100000000) {
+                uint64_t top = high / 100000000;  // at most 1844
+                uint64_t digits = formatEightDigits(static_cast<uint32_t>(top), scratch);
+                int skip = __builtin_ctzll(digits) / 8;
+                memcpy(out, scratch + skip, 8 - skip);
+                out += 8 - skip;
+                formatEightDigits(static_cast<uint32_t>(high % 100000000), out);
+                out += 8;
+            }
+            else {
+                uint64_t digits = formatEightDigits(static_cast<uint32_t>(high), scratch);
+                int skip = __builtin_ctzll(digits) / 8;
+                memcpy(out, scratch + skip, 8 - skip);
+                out += 8 - skip;
+            }
+            formatEightDigits(static_cast<uint32_t>(magnitude % 100000000), out);
+            out += 8;
+        }
+        len = out - buffer.data();
+    }
+};
+
+OutputBuffer& operator<<(OutputBuffer& out, const string& text) {
+    out.writeString(text);
+    return out;
+}
+
+OutputBuffer& operator<<(OutputBuffer& out, const char* text) {
+    out.writeString(text);
+    return out;
+}
+
+OutputBuffer& operator<<(OutputBuffer& out, long long value) {
+    out.writeInt(value);
+    return out;
+}
+
+OutputBuffer& operator<<(OutputBuffer& out, int value) {
+    out.writeInt(value);
+    return out;
+}
+
+OutputBuffer runtimeOut(stdout);
+InputBuffer runtimeIn(stdin);
+
+void flushBeforeRead() {
+    runtimeOut.flush();
+}
+
 struct SymbolTable {
     struct VariableInfo {
-        int value;
+        long long value;  // as wide as Read's readInt
         bool assigned;
     };
 
@@ -140,29 +381,29 @@ struct SymbolTable {
 
     void declareVariable(const string& name) {
         if (variables.find(name) != variables.end()) {
-            cout << "Error: Variable '" << name << "' is already declared!\n";
+            runtimeOut << "Error: Variable '" << name << "' is already declared!\n";
         }
         else {
             variables[name] = { 0, false };
         }
     }
 
-    void assignVariable(const string& name, int value) {
+    void assignVariable(const string& name, long long value) {
         if (variables.find(name) == variables.end()) {
-            cout << "Error: Variable '" << name << "' is not declared!\n";
+            runtimeOut << "Error: Variable '" << name << "' is not declared!\n";
         }
         else {
             variables[name] = { value, true };
         }
     }
 
-    int getValue(const string& name) {
+    long long getValue(const string& name) {
         if (variables.find(name) == variables.end()) {
-            cout << "Error: Variable '" << name << "' is not declared!\n";
+            runtimeOut << "Error: Variable '" << name << "' is not declared!\n";
             return 0;
         }
         if (!variables[name].assigned) {
-            cout << "Error: Variable '" << name << "' is used before assignment!\n";
+            runtimeOut << "Error: Variable '" << name << "' is used before assignment!\n";
             return 0;
         }
         return variables[name].value;
@@ -178,25 +419,145 @@ void parseTokens(const vector<Token>& tokens, SymbolTable& symTable) {
                     i++;
                 }
                 else {
-                    cout << "Syntax Error: Expected identifier after 'Var' at line " << tokens[i].line << "\n";
+                    runtimeOut << "Syntax Error: Expected identifier after 'Var' at line " << tokens[i].line << "\n";
                 }
             }
             else if (tokens[i].value == "Print") {
                 if (i + 2 < tokens.size() && tokens[i + 1].type == SEPARATOR && tokens[i + 1].value == "(" &&
                     tokens[i + 2].type == IDENTIFIER) {
-                    cout << tokens[i + 2].value << " = " << symTable.getValue(tokens[i + 2].value) << "\n";
+                    runtimeOut << tokens[i + 2].value << " = " << symTable.getValue(tokens[i + 2].value) << "\n";
                     i += 3;
                 }
                 else {
-                    cout << "Syntax Error: Incorrect Print statement at line " << tokens[i].line << "\n";
+                    runtimeOut << "Syntax Error: Incorrect Print statement at line " << tokens[i].line << "\n";
+                }
+            }
+            else if (tokens[i].value == "Read") {
+                if (i + 2 < tokens.size() && tokens[i + 1].type == SEPARATOR && tokens[i + 1].value == "(" &&
+                    tokens[i + 2].type == IDENTIFIER) {
+                    long long value;
+                    runtimeIn.readInt(value);
+                    symTable.assignVariable(tokens[i + 2].value, value);
+                    i += 3;
+                }
+                else {
+                    runtimeOut << "Syntax Error: Incorrect Read statement at line " << tokens[i].line << "\n";
                 }
             }
         }
     }
 }
 
-int main() {
+// Integers per second through the runtime against iostreams
+void benchmarkIO(size_t count) {
+    using Clock = chrono::steady_clock;
+    auto seconds = [](Clock::time_point a, Clock::time_point b) {
+        return chrono::duration<double>(b - a).count();
+    };
+    const string path = "/tmp/simple_io_bench.txt";
+    mt19937_64 rng(7);
+    vector<long long> values(count);
+    for (auto& v : values) {
+        int digits = static_cast<int>(rng() % 19) + 1;
+        long long limit = 1;
+        for (int d = 1; d < digits; d++) limit *= 10;
+        v = static_cast<long long>(rng() % static_cast<uint64_t>(limit));
+        if (rng() & 1) v = -v;
+    }
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        OutputBuffer out(file);
+        for (long long v : values) {
+            out.writeInt(v);
+            out.writeChar('\n');
+        }
+        out.flush();
+        fclose(file);
+    }
+
+    long long checksum = 0, expected = 0;
+    for (long long v : values) expected += v;
+
+    auto t0 = Clock::now();
+    {
+        ifstream in(path);
+        long long v;
+        checksum = 0;
+        while (in >> v) checksum += v;
+    }
+    double streamIn = seconds(t0, Clock::now());
+    bool streamOk = checksum == expected;
+
+    auto t1 = Clock::now();
+    {
+        FILE* file = fopen(path.c_str(), "r");
+        InputBuffer in(file);
+        long long v;
+        checksum = 0;
+        while (in.readInt(v)) checksum += v;
+        fclose(file);
+    }
+    double bufferedIn = seconds(t1, Clock::now());
+    bool bufferedOk = checksum == expected;
+
+    auto t2 = Clock::now();
+    {
+        ofstream out("/dev/null");
+        for (long long v : values) out << v << '\n';
+    }
+    double streamOut = seconds(t2, Clock::now());
+
+    auto t3 = Clock::now();
+    {
+        FILE* file = fopen("/dev/null", "w");
+        OutputBuffer out(file);
+        for (long long v : values) {
+            out.writeInt(v);
+            out.writeChar('\n');
+        }
+        out.flush();
+        fclose(file);
+    }
+    double bufferedOut = seconds(t3, Clock::now());
+    remove(path.c_str());
+
+    // Out-of-range and boundary values must read as `cin >> long long` does
+    const char* edges[] = {"3000000000", "99999999999999999999", "-99999999999999999999",
+                           "9223372036854775807", "-9223372036854775808", "9223372036854775808", "-0"};
+    int edgeMismatches = 0;
+    for (const char* edge : edges) {
+        istringstream stream(edge);
+        long long expectedValue = 0;
+        bool expectedOk = static_cast<bool>(stream >> expectedValue);
+        FILE* file = fmemopen(const_cast<char*>(edge), strlen(edge), "r");
+        InputBuffer in(file);
+        long long v;
+        bool ok = in.readInt(v);
+        fclose(file);
+        if (ok != expectedOk || v != expectedValue) {
+            cout << "Edge case " << edge << ": runtime " << v << ", iostream " << expectedValue << "\n";
+            edgeMismatches++;
+        }
+    }
+
+    cout << "Edge cases:     " << (edgeMismatches ? "DIFFER" : "match iostream") << "\n";
+    cout << "Read  iostream: " << count / streamIn / 1e6 << " M ints/s" << (streamOk ? "" : " (checksum DIFFERS)") << "\n";
+    cout << "Read  runtime:  " << count / bufferedIn / 1e6 << " M ints/s" << (bufferedOk ? "" : " (checksum DIFFERS)") << "\n";
+    cout << "Print iostream: " << count / streamOut / 1e6 << " M ints/s\n";
+    cout << "Print runtime:  " << count / bufferedOut / 1e6 << " M ints/s\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench-io") {
+        benchmarkIO(argc > 2 ? stoul(argv[2]) : 10000000);
+        return 0;
+    }
+
     string code = "Program Var x;\nStart Print 23;\nEnd";
+    if (argc > 1) {
+        ifstream file(argv[1]);
+        code.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
 
     vector<Token> tokens = lexicalAnalyzer(code);
 
@@ -204,6 +565,7 @@ int main() {
 
     SymbolTable symTable;
     parseTokens(tokens, symTable);
+    runtimeOut.flush();
 
     return 0;
 }
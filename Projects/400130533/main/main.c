@@ -1,283 +1,182 @@
 #include <stdio.h>
-#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
-
-typedef enum {
-    TOKEN_VAR,
-    TOKEN_IDENTIFIER,
-    TOKEN_SEMICOLON,
-    TOKEN_START,
-    TOKEN_END,
-    TOKEN_PRINT,
-    TOKEN_LPAREN,
-    TOKEN_RPAREN,
-    TOKEN_READ,
-    TOKEN_IF,
-    TOKEN_LBRACE,
-    TOKEN_RBRACE,
-    TOKEN_ITERATION,
-    TOKEN_PUT,
-    TOKEN_EQ,
-    TOKEN_LT, // <
-    TOKEN_GT, // >
-    TOKEN_EQEQ, // ==
-    TOKEN_PLUS,
-    TOKEN_MINUS,
-    TOKEN_TIMES,
-    TOKEN_INTEGER,
-    TOKEN_EOF,
-    TOKEN_ERROR
-} TokenType;
-
-typedef struct {
-    TokenType type;
-    char value[100];
-} Token;
-
-Token getNextToken(char *input, int *index) {
-    Token token;
-    int i = *index;
-
-    // Skip whitespace
-    while (isspace(input[i])) {
-        i++;
+#include <pthread.h>
+#include <time.h>
+#include "parser.h"
+
+// Build: cc -std=c99 -O2 -pthread main.c parser.c -o parser
+//
+//     ./parser              reads the program from stdin, up to a line with End
+//     ./parser file.txt     parses a file
+//     ./parser --bench [max_threads] [programs]
+
+static char *readAll(FILE *in, size_t *length, int stopAtEnd) {
+    size_t capacity = 1024;
+    size_t used = 0;
+    char *text = malloc(capacity);
+    if (text == NULL) {
+        return NULL;
     }
-
-    if (isalpha(input[i])) {
-        int j = 0;
-        while (isalnum(input[i])) {
-            token.value[j++] = input[i++];
-        }
-        token.value[j] = '\0';
-        if (strcmp(token.value, "Var") == 0) {
-            token.type = TOKEN_VAR;
-        } else if (strcmp(token.value, "Start") == 0) {
-            token.type = TOKEN_START;
-        } else if (strcmp(token.value, "End") == 0) {
-            token.type = TOKEN_END;
-        } else if (strcmp(token.value, "Print") == 0) {
-            token.type = TOKEN_PRINT;
-        } else if (strcmp(token.value, "Read") == 0) {
-            token.type = TOKEN_READ;
-        } else if (strcmp(token.value, "If") == 0) {
-            token.type = TOKEN_IF;
-        } else if (strcmp(token.value, "Iteration") == 0) {
-            token.type = TOKEN_ITERATION;
-        } else if (strcmp(token.value, "Put") == 0) {
-            token.type = TOKEN_PUT;
-        } else {
-            token.type = TOKEN_IDENTIFIER;
+    text[0] = '\0';
+    size_t lineStart = 0;
+    while (fgets(text + used, (int)(capacity - used), in)) {
+        used += strlen(text + used);
+        if (stopAtEnd && strstr(text + lineStart, "End") != NULL) {
+            break;
         }
-    } else if (isdigit(input[i])) {
-        int j = 0;
-        while (isdigit(input[i])) {
-            token.value[j++] = input[i++];
+        if (text[used - 1] == '\n') {
+            lineStart = used;
         }
-        token.value[j] = '\0';
-        token.type = TOKEN_INTEGER;
-    } else if (input[i] == ';') {
-        token.type = TOKEN_SEMICOLON;
-        token.value[0] = ';';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '(') {
-        token.type = TOKEN_LPAREN;
-        token.value[0] = '(';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == ')') {
-        token.type = TOKEN_RPAREN;
-        token.value[0] = ')';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '{') {
-        token.type = TOKEN_LBRACE;
-        token.value[0] = '{';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '}') {
-        token.type = TOKEN_RBRACE;
-        token.value[0] = '}';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '=') {
-        if (input[i + 1] == '=') {
-            token.type = TOKEN_EQEQ;
-            token.value[0] = '=';
-            token.value[1] = '=';
-            token.value[2] = '\0';
-            i += 2;
-        } else {
-            token.type = TOKEN_EQ;
-            token.value[0] = '=';
-            token.value[1] = '\0';
-            i++;
+        if (used + 1 == capacity) {
+            char *grown = realloc(text, capacity * 2);
+            if (grown == NULL) {
+                free(text);
+                return NULL;
+            }
+            text = grown;
+            capacity *= 2;
         }
-    } else if (input[i] == '<') {
-        token.type = TOKEN_LT;
-        token.value[0] = '<';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '>') {
-        token.type = TOKEN_GT;
-        token.value[0] = '>';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '+') {
-        token.type = TOKEN_PLUS;
-        token.value[0] = '+';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '-') {
-        token.type = TOKEN_MINUS;
-        token.value[0] = '-';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '*') {
-        token.type = TOKEN_TIMES;
-        token.value[0] = '*';
-        token.value[1] = '\0';
-        i++;
-    } else if (input[i] == '\0') {
-        token.type = TOKEN_EOF;
-        token.value[0] = '\0';
-    } else {
-        token.type = TOKEN_ERROR;
-        sprintf(token.value, "Invalid character: %c", input[i]);
-        i++;
     }
-
-    *index = i;
-    return token;
+    *length = used;
+    return text;
 }
 
-Token currentToken;
-
-void getNextTokenWrapper(char *input, int *index) {
-    currentToken = getNextToken(input, index);
+typedef struct {
+    const char **programs;
+    const size_t *lengths;
+    size_t count;
+    size_t first;
+    size_t step;
+    int rounds;
+    size_t bytes;
+    size_t rejected;
+} Worker;
+
+// Every thread parses its share of the programs with a context of its own
+static void *work(void *arg) {
+    Worker *worker = arg;
+    ParserContext *ctx = parser_create(NULL);
+    if (ctx == NULL) {
+        return NULL;
+    }
+    for (int round = 0; round < worker->rounds; round++) {
+        for (size_t i = worker->first; i < worker->count; i += worker->step) {
+            if (parser_parse(ctx, worker->programs[i], worker->lengths[i]) != PARSER_OK) {
+                worker->rejected++;
+            }
+            worker->bytes += worker->lengths[i];
+        }
+    }
+    parser_destroy(ctx);
+    return NULL;
 }
 
-void match(TokenType expectedType, char *input, int *index) {
-    if (currentToken.type == expectedType) {
-        getNextTokenWrapper(input, index);
-    } else {
-        fprintf(stderr, "Syntax error: Expected %d, but got %d\n", expectedType, currentToken.type);
-        exit(1);
-    }
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
 
-void program(char *input, int *index);
-void statement_list(char *input, int *index);
-void statement(char *input, int *index);
-void expression(char *input, int *index);
-void condition(char *input, int *index);
+// Parses the same programs with 1, 2, 4, ... threads. Every 16th program
+// has a syntax error, so the rejected count shows that no thread sees
+// another's state.
+static int benchmark(int maxThreads, size_t count) {
+    const char **programs = malloc(count * sizeof(char *));
+    size_t *lengths = malloc(count * sizeof(size_t));
+    size_t expectedRejected = 0;
+    for (size_t p = 0; p < count; p++) {
+        size_t capacity = 32 * 1024;
+        char *text = malloc(capacity);
+        size_t used = (size_t)sprintf(text, "Var x;\nVar y;\nStart\n");
+        for (int s = 0; used + 1024 < capacity; s++) {
+            switch ((p + s) % 4) {
+            case 0:
+                used += sprintf(text + used, "  Put x = x + %d * y;\n", s);
+                break;
+            case 1:
+                used += sprintf(text + used, "  If (x < %d) { Read(y); Print(x - y); }\n", s);
+                break;
+            case 2:
+                // Longer than the old char value[100] held
+                used += sprintf(text + used, "  Print(%0150d + a%0200d);\n", s, s);
+                break;
+            default:
+                used += sprintf(text + used, "  Iteration (y > 0) { Put y = y - 1; }\n");
+                break;
+            }
+        }
+        used += sprintf(text + used, p % 16 == 15 ? "  Put = 1;\nEnd\n" : "End\n");
+        expectedRejected += p % 16 == 15;
+        programs[p] = text;
+        lengths[p] = used;
+    }
 
-void program(char *input, int *index) {
-    while (currentToken.type == TOKEN_VAR) {
-        match(TOKEN_VAR, input, index);
-        match(TOKEN_IDENTIFIER, input, index);
-        match(TOKEN_SEMICOLON, input, index);
+    printf("%lu programs, %d rounds each\n", (unsigned long)count, 8);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        pthread_t ids[64];
+        Worker workers[64];
+        double start = now();
+        for (int t = 0; t < threads; t++) {
+            workers[t] = (Worker){ programs, lengths, count, (size_t)t, (size_t)threads, 8, 0, 0 };
+            pthread_create(&ids[t], NULL, work, &workers[t]);
+        }
+        size_t bytes = 0;
+        size_t rejected = 0;
+        for (int t = 0; t < threads; t++) {
+            pthread_join(ids[t], NULL);
+            bytes += workers[t].bytes;
+            rejected += workers[t].rejected;
+        }
+        double seconds = now() - start;
+        printf("%2d threads  %8.1f MB/s  %8.0f programs/s  rejected %lu of %lu%s\n", threads,
+               bytes / seconds / 1e6, count * 8 / seconds, (unsigned long)rejected, (unsigned long)(count * 8),
+               rejected == expectedRejected * 8 ? "" : "  WRONG");
     }
-    match(TOKEN_START, input, index);
-    statement_list(input, index);
-    match(TOKEN_END, input, index);
-}
 
-void statement_list(char *input, int *index) {
-    if (currentToken.type == TOKEN_PRINT ||
-        currentToken.type == TOKEN_READ ||
-        currentToken.type == TOKEN_IF ||
-        currentToken.type == TOKEN_ITERATION ||
-        currentToken.type == TOKEN_PUT) {
-        statement(input, index);
-        statement_list(input, index);
+    for (size_t p = 0; p < count; p++) {
+        free((char *)programs[p]);
     }
-    // Epsilon production: do nothing
+    free(programs);
+    free(lengths);
+    return 0;
 }
 
-void statement(char *input, int *index) {
-    if (currentToken.type == TOKEN_PRINT) {
-        match(TOKEN_PRINT, input, index);
-        match(TOKEN_LPAREN, input, index);
-        expression(input, index);
-        match(TOKEN_RPAREN, input, index);
-        match(TOKEN_SEMICOLON, input, index);
-    } else if (currentToken.type == TOKEN_READ) {
-        match(TOKEN_READ, input, index);
-        match(TOKEN_LPAREN, input, index);
-        match(TOKEN_IDENTIFIER, input, index);
-        match(TOKEN_RPAREN, input, index);
-        match(TOKEN_SEMICOLON, input, index);
-    } else if (currentToken.type == TOKEN_PUT) {
-        match(TOKEN_PUT, input, index);
-        match(TOKEN_IDENTIFIER, input, index);
-        match(TOKEN_EQ, input, index);
-        expression(input, index);
-        match(TOKEN_SEMICOLON, input, index);
-    } else if (currentToken.type == TOKEN_IF) {
-        match(TOKEN_IF, input, index);
-        match(TOKEN_LPAREN, input, index);
-        condition(input, index);
-        match(TOKEN_RPAREN, input, index);
-        match(TOKEN_LBRACE, input, index);
-        statement_list(input, index);
-        match(TOKEN_RBRACE, input, index);
-    } else if (currentToken.type == TOKEN_ITERATION) {
-        match(TOKEN_ITERATION, input, index);
-        match(TOKEN_LPAREN, input, index);
-        condition(input, index);
-        match(TOKEN_RPAREN, input, index);
-        match(TOKEN_LBRACE, input, index);
-        statement_list(input, index);
-        match(TOKEN_RBRACE, input, index);
-    } else {
-        fprintf(stderr, "Syntax error: Unexpected token %d\n", currentToken.type);
-        exit(1);
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        int threads = argc > 2 ? atoi(argv[2]) : 8;
+        return benchmark(threads < 1 ? 1 : threads > 64 ? 64 : threads,
+                         argc > 3 ? strtoul(argv[3], NULL, 10) : 256);
     }
-}
 
-void expression(char *input, int *index) {
-    // Simplified expression parsing for demonstration purposes
-    if (currentToken.type == TOKEN_IDENTIFIER || currentToken.type == TOKEN_INTEGER) {
-        getNextTokenWrapper(input, index);
-        if (currentToken.type == TOKEN_PLUS || currentToken.type == TOKEN_MINUS || currentToken.type == TOKEN_TIMES) {
-            getNextTokenWrapper(input, index);
-            expression(input, index);
+    FILE *in = stdin;
+    if (argc >= 2) {
+        in = fopen(argv[1], "r");
+        if (in == NULL) {
+            fprintf(stderr, "Cannot open %s\n", argv[1]);
+            return 1;
         }
     } else {
-        fprintf(stderr, "Syntax error in expression\n");
-        exit(1);
+        printf("Enter your code (end with 'End'):\n");
+    }
+    size_t length = 0;
+    char *input = readAll(in, &length, in == stdin);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (input == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
     }
-}
 
-void condition(char *input, int *index) {
-    expression(input, index);
-    if (currentToken.type == TOKEN_LT || currentToken.type == TOKEN_GT || currentToken.type == TOKEN_EQEQ) {
-        getNextTokenWrapper(input, index);
-        expression(input, index);
+    ParserContext *ctx = parser_create(NULL);
+    ParserStatus status = ctx != NULL ? parser_parse(ctx, input, length) : PARSER_OUT_OF_MEMORY;
+    if (status == PARSER_OK) {
+        printf("Parsing successful!\n");
     } else {
-        fprintf(stderr, "Syntax error in condition\n");
-        exit(1);
+        fprintf(stderr, "%s\n", ctx != NULL ? parser_error(ctx) : "Out of memory");
     }
+    parser_destroy(ctx);
+    free(input);
+    return status == PARSER_OK ? 0 : 1;
 }
-
-int main() {
-    char input[1024];
-    int index = 0;
-
-    printf("Enter your code (end with 'End'):\n");
-    while (fgets(input + index, sizeof(input) - index, stdin)) {
-        index += strlen(input + index);
-        if (strstr(input, "End") != NULL) {
-            break;
-        }
-    }
-
-    index = 0;
-    currentToken.type = TOKEN_ERROR; // Initialize currentToken to a safe default
-    getNextTokenWrapper(input, &index);
-    program(input, &index);
-    printf("Parsing successful!\n");
-    return 0;
-}
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdlib.h>
+#include "parser.h"
+
+struct ParserContext {
+    ParserAllocator allocator;
+
+    const char *source;
+    size_t length;
+    size_t index;
+    int line;
+    Token currentToken;
+    int depth;
+
+    ParserStatus status;
+    const char *message;
+    char *messageBuffer;
+    size_t messageSize;
+
+    Token *tokens;
+    size_t tokenCount;
+    size_t tokenCapacity;
+};
+
+static void *defaultAlloc(void *user, size_t size) {
+    (void)user;
+    return malloc(size);
+}
+
+static void defaultRelease(void *user, void *ptr, size_t size) {
+    (void)user;
+    (void)size;
+    free(ptr);
+}
+
+static const char *tokenNames[] = {
+    "VAR", "IDENTIFIER", "SEMICOLON", "START", "END", "PRINT", "LPAREN", "RPAREN", "READ", "IF",
+    "LBRACE", "RBRACE", "ITERATION", "PUT", "EQ", "LT", "GT", "EQEQ", "PLUS", "MINUS", "TIMES",
+    "INTEGER", "EOF", "ERROR"
+};
+
+const char *parser_token_name(TokenType type) {
+    return type <= TOKEN_ERROR ? tokenNames[type] : "?";
+}
+
+ParserContext *parser_create(const ParserAllocator *allocator) {
+    ParserAllocator defaults = { defaultAlloc, defaultRelease, NULL };
+    if (allocator == NULL) {
+        allocator = &defaults;
+    }
+    ParserContext *ctx = allocator->alloc(allocator->user, sizeof(ParserContext));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->allocator = *allocator;
+    ctx->message = "";
+    return ctx;
+}
+
+void parser_destroy(ParserContext *ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    ParserAllocator allocator = ctx->allocator;
+    if (ctx->messageBuffer != NULL) {
+        allocator.release(allocator.user, ctx->messageBuffer, ctx->messageSize);
+    }
+    if (ctx->tokens != NULL) {
+        allocator.release(allocator.user, ctx->tokens, ctx->tokenCapacity * sizeof(Token));
+    }
+    allocator.release(allocator.user, ctx, sizeof(ParserContext));
+}
+
+const char *parser_error(const ParserContext *ctx) {
+    return ctx->message;
+}
+
+// Records the first error of a call; later ones are consequences of it
+static void fail(ParserContext *ctx, ParserStatus status, const char *format, ...) {
+    if (ctx->status != PARSER_OK) {
+        return;
+    }
+    ctx->status = status;
+
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (needed < 0) {
+        ctx->message = "error";
+        return;
+    }
+    if ((size_t)needed + 1 > ctx->messageSize) {
+        char *buffer = ctx->allocator.alloc(ctx->allocator.user, (size_t)needed + 1);
+        if (buffer == NULL) {
+            ctx->message = status == PARSER_OUT_OF_MEMORY ? "out of memory" : "error (no memory for the message)";
+            return;
+        }
+        if (ctx->messageBuffer != NULL) {
+            ctx->allocator.release(ctx->allocator.user, ctx->messageBuffer, ctx->messageSize);
+        }
+        ctx->messageBuffer = buffer;
+        ctx->messageSize = (size_t)needed + 1;
+    }
+    va_start(args, format);
+    vsnprintf(ctx->messageBuffer, ctx->messageSize, format, args);
+    va_end(args);
+    ctx->message = ctx->messageBuffer;
+}
+
+static TokenType keyword(const char *text, size_t length) {
+    switch (length) {
+    case 2:
+        if (memcmp(text, "If", 2) == 0) return TOKEN_IF;
+        break;
+    case 3:
+        if (memcmp(text, "Var", 3) == 0) return TOKEN_VAR;
+        if (memcmp(text, "End", 3) == 0) return TOKEN_END;
+        if (memcmp(text, "Put", 3) == 0) return TOKEN_PUT;
+        break;
+    case 4:
+        if (memcmp(text, "Read", 4) == 0) return TOKEN_READ;
+        break;
+    case 5:
+        if (memcmp(text, "Start", 5) == 0) return TOKEN_START;
+        if (memcmp(text, "Print", 5) == 0) return TOKEN_PRINT;
+        break;
+    case 9:
+        if (memcmp(text, "Iteration", 9) == 0) return TOKEN_ITERATION;
+        break;
+    }
+    return TOKEN_IDENTIFIER;
+}
+
+Token parser_next_token(const char *source, size_t length, size_t *index, int *line) {
+    Token token;
+    size_t i = *index;
+
+    // Skip whitespace
+    while (i < length && isspace((unsigned char)source[i])) {
+        if (source[i] == '\n') {
+            (*line)++;
+        }
+        i++;
+    }
+
+    token.text.start = source + i;
+    token.line = *line;
+    if (i >= length || source[i] == '\0') {
+        token.type = TOKEN_EOF;
+        token.text.length = 0;
+        *index = i;
+        return token;
+    }
+
+    unsigned char c = (unsigned char)source[i];
+    size_t start = i++;
+    if (isalpha(c)) {
+        while (i < length && isalnum((unsigned char)source[i])) {
+            i++;
+        }
+        token.type = keyword(source + start, i - start);
+    } else if (isdigit(c)) {
+        while (i < length && isdigit((unsigned char)source[i])) {
+            i++;
+        }
+        token.type = TOKEN_INTEGER;
+    } else {
+        switch (c) {
+        case ';': token.type = TOKEN_SEMICOLON; break;
+        case '(': token.type = TOKEN_LPAREN; break;
+        case ')': token.type = TOKEN_RPAREN; break;
+        case '{': token.type = TOKEN_LBRACE; break;
+        case '}': token.type = TOKEN_RBRACE; break;
+        case '<': token.type = TOKEN_LT; break;
+        case '>': token.type = TOKEN_GT; break;
+        case '+': token.type = TOKEN_PLUS; break;
+        case '-': token.type = TOKEN_MINUS; break;
+        case '*': token.type = TOKEN_TIMES; break;
+        case '=':
+            if (i < length && source[i] == '=') {
+                token.type = TOKEN_EQEQ;
+                i++;
+            } else {
+                token.type = TOKEN_EQ;
+            }
+            break;
+        default: token.type = TOKEN_ERROR; break;
+        }
+    }
+
+    token.text.length = i - start;
+    *index = i;
+    return token;
+}
+
+static void getNextTokenWrapper(ParserContext *ctx) {
+    ctx->currentToken = parser_next_token(ctx->source, ctx->length, &ctx->index, &ctx->line);
+}
+
+static void unexpected(ParserContext *ctx, const char *what) {
+    Token token = ctx->currentToken;
+    if (token.type == TOKEN_ERROR) {
+        fail(ctx, PARSER_SYNTAX_ERROR, "Invalid character: %.*s at line %d", (int)token.text.length,
+             token.text.start, token.line);
+    } else {
+        fail(ctx, PARSER_SYNTAX_ERROR, "%s, but got %s '%.*s' at line %d", what,
+             parser_token_name(token.type), (int)token.text.length, token.text.start, token.line);
+    }
+}
+
+static void match(ParserContext *ctx, TokenType expectedType) {
+    if (ctx->status != PARSER_OK) {
+        return;
+    }
+    if (ctx->currentToken.type == expectedType) {
+        getNextTokenWrapper(ctx);
+    } else {
+        char what[64];
+        snprintf(what, sizeof(what), "Syntax error: Expected %s", parser_token_name(expectedType));
+        unexpected(ctx, what);
+    }
+}
+
+static void statement_list(ParserContext *ctx);
+static void statement(ParserContext *ctx);
+static void expression(ParserContext *ctx);
+static void condition(ParserContext *ctx);
+
+static void program(ParserContext *ctx) {
+    while (ctx->status == PARSER_OK && ctx->currentToken.type == TOKEN_VAR) {
+        match(ctx, TOKEN_VAR);
+        match(ctx, TOKEN_IDENTIFIER);
+        match(ctx, TOKEN_SEMICOLON);
+    }
+    match(ctx, TOKEN_START);
+    statement_list(ctx);
+    match(ctx, TOKEN_END);
+}
+
+// A loop rather than the right recursion of the grammar, so long programs
+// do not use stack per statement
+static void statement_list(ParserContext *ctx) {
+    while (ctx->status == PARSER_OK &&
+           (ctx->currentToken.type == TOKEN_PRINT ||
+            ctx->currentToken.type == TOKEN_READ ||
+            ctx->currentToken.type == TOKEN_IF ||
+            ctx->currentToken.type == TOKEN_ITERATION ||
+            ctx->currentToken.type == TOKEN_PUT)) {
+        statement(ctx);
+    }
+    // Epsilon production: do nothing
+}
+
+// If and Iteration share everything but the keyword
+static void block_statement(ParserContext *ctx, TokenType keywordType) {
+    if (++ctx->depth > PARSER_MAX_DEPTH) {
+        fail(ctx, PARSER_TOO_DEEP, "Parser limit: blocks nested deeper than %d at line %d", PARSER_MAX_DEPTH,
+             ctx->currentToken.line);
+        return;
+    }
+    match(ctx, keywordType);
+    match(ctx, TOKEN_LPAREN);
+    condition(ctx);
+    match(ctx, TOKEN_RPAREN);
+    match(ctx, TOKEN_LBRACE);
+    statement_list(ctx);
+    match(ctx, TOKEN_RBRACE);
+    ctx->depth--;
+}
+
+static void statement(ParserContext *ctx) {
+    if (ctx->currentToken.type == TOKEN_PRINT) {
+        match(ctx, TOKEN_PRINT);
+        match(ctx, TOKEN_LPAREN);
+        expression(ctx);
+        match(ctx, TOKEN_RPAREN);
+        match(ctx, TOKEN_SEMICOLON);
+    } else if (ctx->currentToken.type == TOKEN_READ) {
+        match(ctx, TOKEN_READ);
+        match(ctx, TOKEN_LPAREN);
+        match(ctx, TOKEN_IDENTIFIER);
+        match(ctx, TOKEN_RPAREN);
+        match(ctx, TOKEN_SEMICOLON);
+    } else if (ctx->currentToken.type == TOKEN_PUT) {
+        match(ctx, TOKEN_PUT);
+        match(ctx, TOKEN_IDENTIFIER);
+        match(ctx, TOKEN_EQ);
+        expression(ctx);
+        match(ctx, TOKEN_SEMICOLON);
+    } else if (ctx->currentToken.type == TOKEN_IF || ctx->currentToken.type == TOKEN_ITERATION) {
+        block_statement(ctx, ctx->currentToken.type);
+    } else {
+        unexpected(ctx, "Syntax error: Expected a statement");
+    }
+}
+
+// operand ((+|-|*) operand)*, also as a loop
+static void expression(ParserContext *ctx) {
+    while (ctx->status == PARSER_OK) {
+        if (ctx->currentToken.type != TOKEN_IDENTIFIER && ctx->currentToken.type != TOKEN_INTEGER) {
+            unexpected(ctx, "Syntax error in expression");
+            return;
+        }
+        getNextTokenWrapper(ctx);
+        if (ctx->currentToken.type != TOKEN_PLUS && ctx->currentToken.type != TOKEN_MINUS &&
+            ctx->currentToken.type != TOKEN_TIMES) {
+            return;
+        }
+        getNextTokenWrapper(ctx);
+    }
+}
+
+static void condition(ParserContext *ctx) {
+    expression(ctx);
+    if (ctx->status != PARSER_OK) {
+        return;
+    }
+    if (ctx->currentToken.type == TOKEN_LT || ctx->currentToken.type == TOKEN_GT || ctx->currentToken.type == TOKEN_EQEQ) {
+        getNextTokenWrapper(ctx);
+        expression(ctx);
+    } else {
+        unexpected(ctx, "Syntax error in condition");
+    }
+}
+
+static void reset(ParserContext *ctx, const char *source, size_t length) {
+    ctx->source = source;
+    ctx->length = length;
+    ctx->index = 0;
+    ctx->line = 1;
+    ctx->depth = 0;
+    ctx->status = PARSER_OK;
+    ctx->message = "";
+}
+
+ParserStatus parser_parse(ParserContext *ctx, const char *source, size_t length) {
+    reset(ctx, source, length);
+    getNextTokenWrapper(ctx);
+    program(ctx);
+    return ctx->status;
+}
+
+ParserStatus parser_tokenize(ParserContext *ctx, const char *source, size_t length,
+                             const Token **tokens, size_t *count) {
+    reset(ctx, source, length);
+    ctx->tokenCount = 0;
+    do {
+        if (ctx->tokenCount == ctx->tokenCapacity) {
+            size_t capacity = ctx->tokenCapacity ? ctx->tokenCapacity * 2 : 256;
+            Token *grown = ctx->allocator.alloc(ctx->allocator.user, capacity * sizeof(Token));
+            if (grown == NULL) {
+                fail(ctx, PARSER_OUT_OF_MEMORY, "out of memory after %lu tokens", (unsigned long)ctx->tokenCount);
+                break;
+            }
+            if (ctx->tokens != NULL) {
+                memcpy(grown, ctx->tokens, ctx->tokenCount * sizeof(Token));
+                ctx->allocator.release(ctx->allocator.user, ctx->tokens, ctx->tokenCapacity * sizeof(Token));
+            }
+            ctx->tokens = grown;
+            ctx->tokenCapacity = capacity;
+        }
+        getNextTokenWrapper(ctx);
+        ctx->tokens[ctx->tokenCount++] = ctx->currentToken;
+    } while (ctx->currentToken.type != TOKEN_EOF);
+
+    *tokens = ctx->tokens;
+    *count = ctx->tokenCount;
+    return ctx->status;
+}
@@ -0,0 +1,105 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stddef.h>
+
+/*
+ * Reentrant front end for the Var/Start/End language.
+ *
+ * All state lives in a ParserContext, created with the caller's allocator,
+ * so any number of programs can be parsed at the same time as long as each
+ * thread uses its own context. Nothing calls exit(): errors come back as a
+ * ParserStatus, with a message from parser_error(). Tokens are spans into
+ * the caller's source, so lexemes of any length work and nothing is copied.
+ *
+ *     ParserContext *ctx = parser_create(NULL);
+ *     if (parser_parse(ctx, source, length) != PARSER_OK) {
+ *         fprintf(stderr, "%s\n", parser_error(ctx));
+ *     }
+ *     parser_destroy(ctx);
+ */
+
+typedef enum {
+    TOKEN_VAR,
+    TOKEN_IDENTIFIER,
+    TOKEN_SEMICOLON,
+    TOKEN_START,
+    TOKEN_END,
+    TOKEN_PRINT,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+    TOKEN_READ,
+    TOKEN_IF,
+    TOKEN_LBRACE,
+    TOKEN_RBRACE,
+    TOKEN_ITERATION,
+    TOKEN_PUT,
+    TOKEN_EQ,
+    TOKEN_LT, // <
+    TOKEN_GT, // >
+    TOKEN_EQEQ, // ==
+    TOKEN_PLUS,
+    TOKEN_MINUS,
+    TOKEN_TIMES,
+    TOKEN_INTEGER,
+    TOKEN_EOF,
+    TOKEN_ERROR
+} TokenType;
+
+// A piece of the source text. It is not NUL-terminated.
+typedef struct {
+    const char *start;
+    size_t length;
+} Span;
+
+typedef struct {
+    TokenType type;
+    Span text;
+    int line;
+} Token;
+
+// Where a context gets its memory. alloc returns NULL when it has none;
+// release gets back the pointer and the size that was asked for.
+typedef struct {
+    void *(*alloc)(void *user, size_t size);
+    void (*release)(void *user, void *ptr, size_t size);
+    void *user;
+} ParserAllocator;
+
+typedef enum {
+    PARSER_OK,
+    PARSER_SYNTAX_ERROR,
+    PARSER_OUT_OF_MEMORY,
+    PARSER_TOO_DEEP     // valid so far, but nested past PARSER_MAX_DEPTH
+} ParserStatus;
+
+// If and Iteration bodies nest by recursion; deeper programs fail with
+// PARSER_TOO_DEEP instead of running a small thread stack out
+#ifndef PARSER_MAX_DEPTH
+#define PARSER_MAX_DEPTH 1000
+#endif
+
+typedef struct ParserContext ParserContext;
+
+// allocator may be NULL for malloc/free. Returns NULL when out of memory.
+ParserContext *parser_create(const ParserAllocator *allocator);
+void parser_destroy(ParserContext *ctx);
+
+// Parses source[0, length). Stops at the first error.
+ParserStatus parser_parse(ParserContext *ctx, const char *source, size_t length);
+
+// Lexes source[0, length) up to and including the TOKEN_EOF token. The
+// array belongs to the context and is valid until its next call.
+ParserStatus parser_tokenize(ParserContext *ctx, const char *source, size_t length,
+                             const Token **tokens, size_t *count);
+
+// Message for the last failed call, "" after a successful one
+const char *parser_error(const ParserContext *ctx);
+
+// The lexer on its own: returns the token at *index and moves *index and
+// *line past it. Needs no context.
+Token parser_next_token(const char *source, size_t length, size_t *index, int *line);
+
+const char *parser_token_name(TokenType type);
+
+#endif // PARSER_H
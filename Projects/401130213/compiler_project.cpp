@@ -2,11 +2,30 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <windows.h>
-#include <conio.h>
 #include <iomanip>
 #include <fstream>
 #include <streambuf>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #define defcolor 7
 #define graycolor 8
@@ -18,10 +37,127 @@
 
 using namespace std;
 
-HANDLE hand = GetStdHandle(STD_OUTPUT_HANDLE);
-void gotoxy(short x, short y) {
-    COORD pos = { x,y };
-    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), pos);
+// All output goes through one buffer that is written in large blocks.
+// Colors keep the console attribute numbers above and become ANSI escapes,
+// but only when the stream is a terminal; piped or redirected output is
+// plain text. Windows 10 consoles understand the same escapes once
+// virtual terminal processing is switched on.
+class Console {
+public:
+    explicit Console(FILE* stream) : Console(stream, isTerminal(stream)) {}
+
+    Console(FILE* stream, bool colors) : stream(stream), colors(colors) {
+#ifdef _WIN32
+        DWORD mode = 0;
+        HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+        if (colors && GetConsoleMode(handle, &mode)) {
+            SetConsoleMode(handle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+#endif
+    }
+
+    ~Console() {
+        flush();
+    }
+
+    Console& operator<<(const string& text) {
+        buffer += text;
+        return spill();
+    }
+
+    Console& operator<<(const char* text) {
+        buffer += text;
+        return spill();
+    }
+
+    Console& operator<<(char c) {
+        buffer += c;
+        return spill();
+    }
+
+    Console& operator<<(size_t number) {
+        buffer += to_string(number);
+        return spill();
+    }
+
+    Console& operator<<(int number) {
+        buffer += to_string(number);
+        return spill();
+    }
+
+    // Right-aligned in width columns, like `cout << setw(width) << text`
+    Console& pad(const string& text, size_t width) {
+        if (text.size() < width) {
+            buffer.append(width - text.size(), ' ');
+        }
+        return *this << text;
+    }
+
+    void color(int attribute) {
+        if (!colors) {
+            return;
+        }
+        buffer += escape(attribute);
+    }
+
+    static string escape(int attribute) {
+        if (attribute == defcolor) {
+            return "\x1b[0m";
+        }
+        // Console attributes are IRGB bits, ANSI colors are BGR
+        int ansi = ((attribute & 4) ? 1 : 0) | ((attribute & 2) ? 2 : 0) | ((attribute & 1) ? 4 : 0);
+        return "\x1b[" + to_string(((attribute & 8) ? 90 : 30) + ansi) + "m";
+    }
+
+    void gotoxy(short x, short y) {
+        if (colors) {
+            buffer += "\x1b[" + to_string(y + 1) + ";" + to_string(x + 1) + "H";
+        }
+    }
+
+    void clear() {
+        if (colors) {
+            buffer += "\x1b[2J\x1b[H";
+        }
+    }
+
+    void flush() {
+        fwrite(buffer.data(), 1, buffer.size(), stream);
+        fflush(stream);
+        buffer.clear();
+    }
+
+    static bool isTerminal(FILE* stream) {
+#ifdef _WIN32
+        return _isatty(_fileno(stream));
+#else
+        return isatty(fileno(stream));
+#endif
+    }
+
+private:
+    FILE* stream;
+    bool colors;
+    string buffer;
+
+    Console& spill() {
+        if (buffer.size() >= (1 << 20)) {
+            flush();
+        }
+        return *this;
+    }
+};
+
+Console console(stdout);
+
+// Waits for a key in the interactive menus; the batch mode never calls it
+void waitForKey() {
+    console.flush();
+#ifdef _WIN32
+    _getch();
+#else
+    cin.get();
+#endif
 }
 
 enum Token_Type {
@@ -51,42 +187,90 @@ struct Token {
     int line = 1;
 };
 
+// Trace levels, fixed at compile time with -DTRACE_LEVEL=...: TRACE_MATCHES
+// prints match(<TOKEN>) for every token the parser accepts, as it always
+// did, and TRACE_TOKENS also every token the lexer returns. Events above
+// the level are discarded by `if constexpr`, so at TRACE_OFF the lexer and
+// parser contain no trace formatting or I/O at all. Syntax errors are
+// diagnostics, not traces, and are printed at every level.
+enum TraceLevel { TRACE_OFF, TRACE_MATCHES, TRACE_TOKENS };
 
-Token getNextToken(const string& input, size_t& pos, int& current_line) {
-    while (pos < input.length() && isspace(input[pos])) {
-        string temp;
-        temp = temp + input[pos];
-        if (temp == "\n") {
-            current_line += 1;
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_MATCHES
+#endif
+
+struct TraceEvent {
+    const char* what;
+    Token_Type type;
+    size_t index;
+    int line;
+};
+
+// Runtime alternative to printing traces: keeps the last events in a
+// fixed ring, recording each with a few stores. Nothing is formatted until
+// dump(), which compile() calls after parsing (--trace-ring <events>).
+class TraceRing {
+public:
+    explicit TraceRing(size_t capacity) : events(capacity > 0 ? capacity : 1) {}
+
+    void record(const TraceEvent& event) {
+        events[recorded++ % events.size()] = event;
+    }
+
+    void dump(Console& out) {
+        size_t first = recorded > events.size() ? recorded - events.size() : 0;
+        out << "\nLast " << recorded - first << " of " << recorded << " trace events:\n";
+        for (size_t i = first; i < recorded; ++i) {
+            const TraceEvent& event = events[i % events.size()];
+            out << event.what << "(" << tokenTypeNames[event.type] << ") at token index of " << event.index
+                << ", at token line of " << event.line << "\n";
         }
-        pos++;
+        recorded = 0;
     }
 
-    if (pos == input.length()) return { UNKNOWN, "", current_line };
+private:
+    vector<TraceEvent> events;
+    size_t recorded = 0;
+};
 
-    char currentChar = input[pos];
+TraceRing* traceRing = nullptr;
 
-    if (isalpha(currentChar)) {
-        string identifier;
-        while (pos < input.length() && isalnum(input[pos])) {
-            identifier += input[pos++];
-        }
-        if (keywords.find(identifier) != keywords.end()) {
-            return { keywords[identifier], identifier, current_line };
+// Sends the events enabled at Level to the ring if there is one, else to out
+template <TraceLevel Level>
+class Tracer {
+public:
+    Tracer(Console& out, TraceRing* ring) : out(out), ring(ring) {}
+
+    void match(const Token& token, size_t index) {
+        if constexpr (Level >= TRACE_MATCHES) {
+            record("match", token, index);
         }
-        else {
-            return { IDENTIFIER, identifier, current_line };
+    }
+
+    void token(const Token& token, size_t index) {
+        if constexpr (Level >= TRACE_TOKENS) {
+            record("token", token, index);
         }
     }
 
-    if (isdigit(currentChar)) {
-        string number;
-        while (pos < input.length() && isdigit(input[pos])) {
-            number += input[pos++];
+private:
+    Console& out;
+    TraceRing* ring;
+
+    void record(const char* what, const Token& token, size_t index) {
+        if (ring) {
+            ring->record({ what, token.type, index, token.line });
+        }
+        else {
+            out << what << "(" << tokenTypeNames[token.type] << ")\n";
         }
-        return { INTEGER, number, current_line };
     }
+};
 
+
+// Operators and punctuation, shared by both lexers
+Token getSymbolToken(const string& input, size_t& pos, int current_line) {
+    char currentChar = input[pos];
     switch (currentChar) {
     case '=':
         if (input[pos + 1] == '=') {
@@ -112,33 +296,235 @@ Token getNextToken(const string& input, size_t& pos, int& current_line) {
     }
 }
 
+// Vector helpers for skipRun: AVX2 when the compiler targets it (-mavx2),
+// else SSE2, which every x86-64 has. Other targets use the plain loop.
+#if defined(__AVX2__)
+#define LEX_SIMD
+struct Simd {
+    typedef __m256i Vec;
+    static const size_t Width = 32;
+    static const uint32_t All = 0xffffffffu;
+    static Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static Vec set(char c) { return _mm256_set1_epi8(c); }
+    static Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+    static Vec either(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_epi8(a, b); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_epu8(a, b); }
+    static uint32_t mask(Vec v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+#define LEX_SIMD
+struct Simd {
+    typedef __m128i Vec;
+    static const size_t Width = 16;
+    static const uint32_t All = 0xffffu;
+    static Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static Vec set(char c) { return _mm_set1_epi8(c); }
+    static Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+    static Vec either(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_epi8(a, b); }
+    static Vec min(Vec a, Vec b) { return _mm_min_epu8(a, b); }
+    static uint32_t mask(Vec v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+};
+#endif
+
+static inline int lowestBit(uint32_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+static inline int countBits(uint32_t bits) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt(bits));
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+// The runs getNextToken skips over, in the "C" locale meaning of isspace,
+// isalnum and isdigit
+enum RunClass { WHITESPACE_RUN, IDENTIFIER_RUN, DIGIT_RUN };
+
+template <RunClass Run>
+static inline bool inRun(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    if constexpr (Run == WHITESPACE_RUN) {
+        return u == ' ' || static_cast<unsigned char>(u - '\t') <= 4;
+    }
+    else if constexpr (Run == IDENTIFIER_RUN) {
+        return static_cast<unsigned char>(u - '0') <= 9 || static_cast<unsigned char>((u | 0x20) - 'a') <= 25;
+    }
+    else {
+        return static_cast<unsigned char>(u - '0') <= 9;
+    }
+}
+
+#ifdef LEX_SIMD
+// All-ones in the bytes with low <= c <= low + span, as one unsigned compare
+static inline Simd::Vec inRange(Simd::Vec c, char low, char span) {
+    Simd::Vec offset = Simd::sub(c, Simd::set(low));
+    return Simd::eq(Simd::min(offset, Simd::set(span)), offset);
+}
+
+template <RunClass Run>
+static inline uint32_t runMask(Simd::Vec c) {
+    if constexpr (Run == WHITESPACE_RUN) {
+        return Simd::mask(Simd::either(Simd::eq(c, Simd::set(' ')), inRange(c, '\t', 4)));
+    }
+    else if constexpr (Run == IDENTIFIER_RUN) {
+        // OR-ing in 0x20 lowercases letters and moves nothing else into a..z
+        return Simd::mask(Simd::either(inRange(c, '0', 9), inRange(Simd::either(c, Simd::set(0x20)), 'a', 25)));
+    }
+    else {
+        return Simd::mask(inRange(c, '0', 9));
+    }
+}
+#endif
+
+// Returns the end of the Run that starts at pos, a whole vector at a time:
+// the first byte outside the run is the lowest zero bit of the mask, and
+// the newlines crossed are counted with a popcount
+template <RunClass Run>
+static size_t skipRun(const string& input, size_t pos, int& current_line) {
+    const char* data = input.data();
+    size_t size = input.size();
+#ifdef LEX_SIMD
+    while (pos + Simd::Width <= size) {
+        Simd::Vec c = Simd::load(data + pos);
+        uint32_t outside = ~runMask<Run>(c) & Simd::All;
+        if constexpr (Run == WHITESPACE_RUN) {
+            uint32_t run = outside ? (outside & (0u - outside)) - 1 : Simd::All;
+            current_line += countBits(Simd::mask(Simd::eq(c, Simd::set('\n'))) & run);
+        }
+        if (outside) {
+            return pos + lowestBit(outside);
+        }
+        pos += Simd::Width;
+    }
+#endif
+    for (; pos < size && inRun<Run>(data[pos]); ++pos) {
+        if (Run == WHITESPACE_RUN && data[pos] == '\n') {
+            current_line += 1;
+        }
+    }
+    return pos;
+}
+
+Token getNextToken(const string& input, size_t& pos, int& current_line) {
+    pos = skipRun<WHITESPACE_RUN>(input, pos, current_line);
+
+    if (pos == input.length()) return { UNKNOWN, "", current_line };
+
+    char currentChar = input[pos];
+
+    if (isalpha(currentChar)) {
+        size_t start = pos;
+        pos = skipRun<IDENTIFIER_RUN>(input, pos, current_line);
+        string identifier = input.substr(start, pos - start);
+        auto keyword = keywords.find(identifier);
+        if (keyword != keywords.end()) {
+            return { keyword->second, identifier, current_line };
+        }
+        else {
+            return { IDENTIFIER, identifier, current_line };
+        }
+    }
+
+    if (isdigit(currentChar)) {
+        size_t start = pos;
+        pos = skipRun<DIGIT_RUN>(input, pos, current_line);
+        return { INTEGER, input.substr(start, pos - start), current_line };
+    }
+
+    return getSymbolToken(input, pos, current_line);
+}
+
+// getNextToken as it was, a byte and a string append at a time; kept for
+// the --bench-lex comparison
+Token getNextTokenBytewise(const string& input, size_t& pos, int& current_line) {
+    while (pos < input.length() && isspace(input[pos])) {
+        string temp;
+        temp = temp + input[pos];
+        if (temp == "\n") {
+            current_line += 1;
+        }
+        pos++;
+    }
+
+    if (pos == input.length()) return { UNKNOWN, "", current_line };
+
+    char currentChar = input[pos];
+
+    if (isalpha(currentChar)) {
+        string identifier;
+        while (pos < input.length() && isalnum(input[pos])) {
+            identifier += input[pos++];
+        }
+        if (keywords.find(identifier) != keywords.end()) {
+            return { keywords[identifier], identifier, current_line };
+        }
+        else {
+            return { IDENTIFIER, identifier, current_line };
+        }
+    }
+
+    if (isdigit(currentChar)) {
+        string number;
+        while (pos < input.length() && isdigit(input[pos])) {
+            number += input[pos++];
+        }
+        return { INTEGER, number, current_line };
+    }
+
+    return getSymbolToken(input, pos, current_line);
+}
+
+
+// Tokenizes input up to the end or the first unknown character
+template <TraceLevel Level>
+vector<Token> tokenize(const string& input, Tracer<Level> trace) {
+    vector<Token> tokens;
+    size_t pos = 0;
+    int current_line = 1;
+    for (Token token; (token = getNextToken(input, pos, current_line)).type != UNKNOWN;) {
+        trace.token(token, tokens.size());
+        tokens.push_back(token);
+    }
+    return tokens;
+}
 
+template <TraceLevel Level = TraceLevel(TRACE_LEVEL)>
 class Parser {
 public:
-    Parser(const vector<Token>& tokens, bool parserAccept) : tokens(tokens), currentTokenIndex(0), parserAccept(parserAccept) {}
+    Parser(const vector<Token>& tokens, bool parserAccept, Console& out = console, TraceRing* ring = nullptr)
+        : tokens(tokens), currentTokenIndex(0), parserAccept(parserAccept), out(out), trace(out, ring) {}
 
-    void parse() {
-        SetConsoleTextAttribute(hand, bluecolor);
-        cout << "\nPlease enter any button to continue ... \n\n";
-        SetConsoleTextAttribute(hand, defcolor);
-        _getch();
+    bool parse() {
         S();
-        cout << "\n\nParsing complete." << endl;
+        out << "\n\nParsing complete.\n";
         if (parserAccept) {
-            SetConsoleTextAttribute(hand, bluecolor);
-            cout << "\n --- Parser accepted the given string!\n";
+            out.color(bluecolor);
+            out << "\n --- Parser accepted the given string!\n";
         }
         else {
-            SetConsoleTextAttribute(hand, redcolor);
-            cout << "\n --- Parser rejected the given string!";
+            out.color(redcolor);
+            out << "\n --- Parser rejected the given string!\n";
         }
-        SetConsoleTextAttribute(hand, defcolor);
+        out.color(defcolor);
+        return parserAccept;
     }
 
 private:
     vector<Token> tokens;
     size_t currentTokenIndex;
     bool parserAccept;
+    Console& out;
+    Tracer<Level> trace;
 
     void parserReject() {
         parserAccept = false;
@@ -298,14 +684,14 @@ private:
     void expect(Token_Type type) {
         Token token = getNextToken();
         if (token.type != type) {
-            SetConsoleTextAttribute(hand, redcolor);
-            cout << "Syntax error: expected " << tokenTypeNames[type] << ", got " << tokenTypeNames[token.type] << ", at token index of " << currentTokenIndex << ", at token line of " << token.line << endl;
-            SetConsoleTextAttribute(hand, defcolor);
+            out.color(redcolor);
+            out << "Syntax error: expected " << tokenTypeNames[type] << ", got " << tokenTypeNames[token.type] << ", at token index of " << currentTokenIndex << ", at token line of " << token.line << "\n";
+            out.color(defcolor);
             parserReject();
             //exit(1);
         }
         else {
-            cout << "match(" << tokenTypeNames[token.type] << ")\n";
+            trace.match(token, currentTokenIndex - 1);
         }
     }
 
@@ -321,18 +707,20 @@ string mainMenu() {
     int midwayPointX = 60;
     int midwayPointY = 10;
 
+#ifdef _WIN32
     system("MODE 102,60");
+#endif
     string message = "Compiler Final Project";
-    gotoxy(midwayPointX - message.length(), midwayPointY);
-    SetConsoleTextAttribute(hand, yellowcolor);
-    cout << message;
+    console.gotoxy(midwayPointX - message.length(), midwayPointY);
+    console.color(yellowcolor);
+    console << message;
     message = "Designed and programmed by Kiamehr Behnia";
-    gotoxy(midwayPointX - (message.length() / 1.25) + 2, midwayPointY + 1);
-    cout << message;
+    console.gotoxy(midwayPointX - (message.length() / 1.25) + 2, midwayPointY + 1);
+    console << message;
 
-    SetConsoleTextAttribute(hand, bluecolor);
-    gotoxy(0, midwayPointY + 3);
-    cout << R"(                                           .
+    console.color(bluecolor);
+    console.gotoxy(0, midwayPointY + 3);
+    console << R"(                                           .
                                           / \
                                           | |
                                           |.|
@@ -352,41 +740,43 @@ string mainMenu() {
                                                  \ /   | \__
                                                  / |   \____\
                                                  `-')";
-    _getch();
-    SetConsoleTextAttribute(hand, defcolor);
-    system("CLS");
+    waitForKey();
+    console.color(defcolor);
+    console.clear();
 
 
     message = "Please select one of the commands: ";
-    gotoxy(midwayPointX - message.length() / 1.5, midwayPointY);
-    SetConsoleTextAttribute(hand, yellowcolor);
-    cout << message;
+    console.gotoxy(midwayPointX - message.length() / 1.5, midwayPointY);
+    console.color(yellowcolor);
+    console << message;
 
     message = "1- Write your own string. ";
-    gotoxy(midwayPointX - 20, midwayPointY + 2);
-    SetConsoleTextAttribute(hand, greencolor);
-    cout << message;
+    console.gotoxy(midwayPointX - 20, midwayPointY + 2);
+    console.color(greencolor);
+    console << message;
 
     message = "2- Read from a file. ";
-    gotoxy(midwayPointX - 20, midwayPointY + 3);
-    SetConsoleTextAttribute(hand, bluecolor);
-    cout << message;
+    console.gotoxy(midwayPointX - 20, midwayPointY + 3);
+    console.color(bluecolor);
+    console << message;
 
     message = "3- quit. ";
-    gotoxy(midwayPointX - 20, midwayPointY + 4);
-    SetConsoleTextAttribute(hand, redcolor);
-    cout << message;
-    gotoxy(midwayPointX - 20, midwayPointY + 5);
+    console.gotoxy(midwayPointX - 20, midwayPointY + 4);
+    console.color(redcolor);
+    console << message;
+    console.gotoxy(midwayPointX - 20, midwayPointY + 5);
 
-    SetConsoleTextAttribute(hand, defcolor);
+    console.color(defcolor);
+    console.flush();
     string option;
     string input;
     cin >> option;
 
     while (true) {
         if (option == "1") {
-            gotoxy(midwayPointX - 20, midwayPointY + 8);
-            cout << "Please enter a string: \n";
+            console.gotoxy(midwayPointX - 20, midwayPointY + 8);
+            console << "Please enter a string: \n";
+            console.flush();
             cin >> input;
             return input;
         }
@@ -394,18 +784,19 @@ string mainMenu() {
         else if (option == "2") {
             string filename = "input.txt";
             ifstream f(filename);
-            SetConsoleTextAttribute(hand, graycolor);
-            gotoxy(midwayPointX - 20, midwayPointY + 8);
-            cout << "Reading from " << filename << ":\n\n";
-            SetConsoleTextAttribute(hand, defcolor);
+            console.color(graycolor);
+            console.gotoxy(midwayPointX - 20, midwayPointY + 8);
+            console << "Reading from " << filename << ":\n\n";
+            console.color(defcolor);
             if (!f.is_open()) {
+                console.flush();
                 cerr << "Error opening the file!";
                 exit(0);
             }
             string str((istreambuf_iterator<char>(f)),
                 istreambuf_iterator<char>());
-            cout << str;
-            _getch();
+            console << str;
+            waitForKey();
             return str;
         }
 
@@ -418,64 +809,288 @@ string mainMenu() {
 
 }
 
-int main() {
-    string input;
-    input = mainMenu();
-    system("CLS");
-    //string input = "Program Var \n x +; Start Print(x); End end";
-    //string input;
-    //cout << "Please enter your desired text: ";
-    //cin >> input;
-    size_t pos = 0;
-    Token token;
-    vector<Token> tokens;
-
+// One row of the token table, in the layout of the original
+// `cout << setw(...)` loop
+void printToken(Console& out, const Token& token, int text_color) {
+    out.color(defcolor);
+    out << "| Token Type: ";
+    out.color(text_color);
+    out.pad(getTokenName(token.type), 15);
+    out.color(defcolor);
+    out << "|";
+    out.pad("| Value: ", 25);
+    out.color(text_color);
+    out.pad(token.value + "|", 15);
+    out.color(defcolor);
+    out.pad("| Token line: ", 25);
+    out.color(text_color);
+    out.pad(to_string(token.line), 5);
+    out.color(defcolor);
+    out << "|\n";
+}
 
+// Tokenizes and parses one program, printing the input, the token table and
+// the parser's trace. The interactive mode pauses before parsing.
+bool compile(string input, bool interactive) {
     while (input.find("\\n") != string::npos)
         input.replace(input.find("\\n"), 3, "\n");
 
-    //if ("Program Var \n x +; Start Print(x); End end;" == input) {
-    //    cout << "AY!\n";
-    //}
+    console.color(yellowcolor);
+    console << "Input: \n\n" << "`\n";
+    console.color(brightwhitecolor);
+    console << input << "\n\n";
+    console.color(yellowcolor);
+    console << "`\n\n\n";
+    // After the banner, so TRACE_TOKENS lines follow the input they trace
+    console.color(defcolor);
+    vector<Token> tokens = tokenize(input, Tracer<TraceLevel(TRACE_LEVEL)>(console, traceRing));
+    console.color(yellowcolor);
+    console << "Tokenized input:\n\n";
+    console.color(defcolor);
+    int text_color = yellowcolor;
+    console << " __________________________________________________________________________________________________\n";
+    for (const Token& token : tokens) {
+        printToken(console, token, text_color);
+    }
+    console << " --------------------------------------------------------------------------------------------------\n";
+
+    if (interactive) {
+        console.color(bluecolor);
+        console << "\nPlease enter any button to continue ... \n\n";
+        console.color(defcolor);
+        waitForKey();
+    }
+
+    Parser parser(tokens, true, console, traceRing);
+    bool accepted = parser.parse(); // Call the S() function to start parsing
+    if (traceRing) {
+        traceRing->dump(console);
+    }
+    return accepted;
+}
+
+// Batch mode: every file (or stdin for "-") is compiled in turn without
+// waiting for keys. The exit code is 0 if all were accepted, 1 if any was
+// rejected and 2 if a file could not be read.
+int batch(const vector<string>& files) {
+    int status = 0;
+    for (const string& filename : files) {
+        string input;
+        if (filename == "-") {
+            input.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+        }
+        else {
+            ifstream f(filename, ios::binary);
+            if (!f.is_open()) {
+                console.flush();
+                cerr << "Error opening the file " << filename << "!\n";
+                status = 2;
+                continue;
+            }
+            input.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        }
+        if (!compile(input, false) && status == 0) {
+            status = 1;
+        }
+    }
+    console.flush();
+    return status;
+}
 
+// Token table throughput: the old per-token iostream loop (setw, endl, and
+// every color change a separate console write, as SetConsoleTextAttribute
+// was) against printToken into a Console, with and without colors
+int benchmark(size_t count) {
+    string input = "Program\n  Var x;\n  Start\n";
+    for (size_t n = 0; n < count; n += 12) {
+        input += "    Put x = x + 12;\n    Print(x);\n";
+    }
+    input += "  End\nend\n";
+    vector<Token> tokens;
+    size_t pos = 0;
     int current_line = 1;
-    SetConsoleTextAttribute(hand, yellowcolor);
-    cout << "Input: \n\n" << "`\n";
-    SetConsoleTextAttribute(hand, brightwhitecolor);
-    cout << input << "\n\n";
-    SetConsoleTextAttribute(hand, yellowcolor);
-    cout << "`\n\n\n";
-    cout << "Tokenized input:\n\n";
-    SetConsoleTextAttribute(hand, defcolor);
-    int text_color = yellowcolor;
-    cout << " __________________________________________________________________________________________________\n";
-    while ((token = getNextToken(input, pos, current_line)).type != UNKNOWN) {
-        SetConsoleTextAttribute(hand, defcolor);
-        cout << setw(10) << "| Token Type: " << setw(15);
-        SetConsoleTextAttribute(hand, text_color);
-        cout << getTokenName(token.type);
-        SetConsoleTextAttribute(hand, defcolor);
-        cout << "|" << setw(25) << "| Value: " << setw(15);
-        SetConsoleTextAttribute(hand, text_color);
-        cout << token.value + "|" << setw(25);
-        SetConsoleTextAttribute(hand, defcolor);
-        cout << "| Token line: " << setw(5);
-        SetConsoleTextAttribute(hand, text_color);
-        cout << to_string(token.line);
-        SetConsoleTextAttribute(hand, defcolor);
-        cout << "|" << endl;
+    for (Token token; (token = getNextToken(input, pos, current_line)).type != UNKNOWN;) {
         tokens.push_back(token);
     }
-    cout << " --------------------------------------------------------------------------------------------------\n";
 
-    //vector<Token> tokens = {
-    //    {PROGRAM, "Program"}, {VAR, "Var"}, {IDENTIFIER, "x"}, {SEMICOLON, ";"}, {START, "Start"},
-    //    {PRINT, "Print"}, {LPAREN, "("}, {IDENTIFIER, "x"}, {RPAREN, ")"}, {SEMICOLON, ";"},
-    //    {END, "End"}, {PROGRAM_END, "end"}
-    //};
+    const char* filename = "bench_out.txt";
+    auto time = [&](const char* name, auto run) {
+        auto start = chrono::steady_clock::now();
+        run();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        ifstream written(filename, ios::binary | ios::ate);
+        double bytes = static_cast<double>(written.tellg());
+        cout << left << setw(28) << name << right << fixed << setprecision(1) << setw(8) << bytes / seconds / 1e6
+             << " MB/s" << setw(8) << seconds * 1e9 / tokens.size() << " ns/token\n";
+    };
+
+    cout << tokens.size() << " tokens\n";
+    time("iostream, endl per row", [&] {
+        ofstream f(filename, ios::binary);
+        auto color = [&](int attribute) {
+            f << flush << Console::escape(attribute) << flush;
+        };
+        for (const Token& token : tokens) {
+            color(defcolor);
+            f << setw(10) << "| Token Type: " << setw(15);
+            color(yellowcolor);
+            f << getTokenName(token.type);
+            color(defcolor);
+            f << "|" << setw(25) << "| Value: " << setw(15);
+            color(yellowcolor);
+            f << token.value + "|" << setw(25);
+            color(defcolor);
+            f << "| Token line: " << setw(5);
+            color(yellowcolor);
+            f << to_string(token.line);
+            color(defcolor);
+            f << "|" << endl;
+        }
+    });
+    for (bool colors : { true, false }) {
+        time(colors ? "Console, colors" : "Console, plain", [&] {
+            FILE* f = fopen(filename, "wb");
+            {
+                Console out(f, colors);
+                for (const Token& token : tokens) {
+                    printToken(out, token, yellowcolor);
+                }
+            }
+            fclose(f);
+        });
+    }
+    remove(filename);
+    return 0;
+}
+
+// Tokenize and parse throughput for each trace level this file can be
+// built with. Printed traces go to a file through a Console; ring traces
+// go to a 4096-event TraceRing.
+int benchmarkTrace(size_t statements) {
+    string input = "Program\n  Var x;\n  Var i;\n  Start\n";
+    for (size_t n = 0; n < statements; n += 4) {
+        input += "    Put x = x + 12;\n    Print(x);\n"
+                 "    If (x < 10) { Read(x); }\n"
+                 "    Iteration (i > 0) { Put i = i - 1; }\n";
+    }
+    input += "  End\nend\n";
+
+    const char* filename = "bench_out.txt";
+    FILE* f = fopen(filename, "wb");
+    TraceRing ring(4096);
+    auto run = [&](const char* name, auto level, TraceRing* sink) {
+        constexpr TraceLevel Level = decltype(level)::value;
+        Console out(f, false);
+        double best = 1e30;
+        size_t count = 0;
+        bool accepted = false;
+        for (int round = 0; round < 3; ++round) {
+            auto start = chrono::steady_clock::now();
+            vector<Token> tokens = tokenize(input, Tracer<Level>(out, sink));
+            Parser<Level> parser(tokens, true, out, sink);
+            accepted = parser.parse();
+            out.flush();
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            count = tokens.size();
+        }
+        cout << left << setw(26) << name << right << fixed << setprecision(1) << setw(8)
+             << input.size() / best / 1e6 << " MB/s" << setw(8) << best * 1e9 / count << " ns/token"
+             << (accepted ? "" : "  REJECTED") << "\n";
+    };
+
+    cout << input.size() << " bytes of input\n";
+    run("TRACE_OFF", integral_constant<TraceLevel, TRACE_OFF>(), nullptr);
+    run("TRACE_MATCHES, printed", integral_constant<TraceLevel, TRACE_MATCHES>(), nullptr);
+    run("TRACE_MATCHES, ring", integral_constant<TraceLevel, TRACE_MATCHES>(), &ring);
+    run("TRACE_TOKENS, printed", integral_constant<TraceLevel, TRACE_TOKENS>(), nullptr);
+    run("TRACE_TOKENS, ring", integral_constant<TraceLevel, TRACE_TOKENS>(), &ring);
+    fclose(f);
+    remove(filename);
+    return 0;
+}
+
+// Lexer throughput, getNextToken against getNextTokenBytewise, on a
+// whitespace-heavy and an identifier-heavy program of about megabytes MB
+int benchmarkLexer(size_t megabytes) {
+    string blank(60, ' ');
+    string longName = "accumulatedRunningTotalOfEverything";
+    vector<pair<const char*, string>> inputs = {
+        { "whitespace-heavy", "\n\n" + blank + "Put x = x +\t\t1 ;\n" + blank + "\n" + blank + "Print ( x ) ;\n" },
+        { "identifier-heavy", "Put " + longName + " = " + longName + " + " + longName + "2 + 1234567890;\n"
+                              "Print(" + longName + "3);\n" },
+    };
+    for (auto& [name, unit] : inputs) {
+        string input;
+        while (input.size() < (megabytes << 20)) {
+            input += unit;
+        }
+        auto run = [&](const char* lexer, Token (*next)(const string&, size_t&, int&)) {
+            double best = 1e30;
+            size_t count = 0;
+            int lines = 0;
+            for (int round = 0; round < 3; ++round) {
+                auto start = chrono::steady_clock::now();
+                size_t pos = 0;
+                int current_line = 1;
+                count = 0;
+                while (next(input, pos, current_line).type != UNKNOWN) {
+                    count++;
+                }
+                lines = current_line;
+                best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            }
+            cout << left << setw(18) << name << setw(10) << lexer << right << fixed << setprecision(1) << setw(8)
+                 << input.size() / best / 1e6 << " MB/s" << setw(10) << count << " tokens" << setw(9) << lines
+                 << " lines\n";
+        };
+        run("bytewise", getNextTokenBytewise);
+        run("runs", getNextToken);
+    }
+    cout << "(runs use " << (
+#if defined(__AVX2__)
+        "AVX2"
+#elif defined(LEX_SIMD)
+        "SSE2"
+#else
+        "no SIMD"
+#endif
+        ")\n");
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+    if (!args.empty() && args[0] == "--bench") {
+        return benchmark(args.size() > 1 ? strtoul(args[1].c_str(), nullptr, 10) : 1000000);
+    }
+    if (!args.empty() && args[0] == "--bench-lex") {
+        return benchmarkLexer(args.size() > 1 ? strtoul(args[1].c_str(), nullptr, 10) : 64);
+    }
+    if (!args.empty() && args[0] == "--bench-trace") {
+        return benchmarkTrace(args.size() > 1 ? strtoul(args[1].c_str(), nullptr, 10) : 200000);
+    }
+    unique_ptr<TraceRing> ring;
+    if (args.size() >= 2 && args[0] == "--trace-ring") {
+        ring = make_unique<TraceRing>(strtoul(args[1].c_str(), nullptr, 10));
+        traceRing = ring.get();
+        args.erase(args.begin(), args.begin() + 2);
+    }
+    if (!args.empty() && args[0] == "--batch") {
+        args.erase(args.begin());
+        if (args.empty()) {
+            args.push_back("-");
+        }
+    }
+    // Files on the command line or a program piped in: nothing to ask the user
+    if (!args.empty() || !Console::isTerminal(stdin)) {
+        return batch(args.empty() ? vector<string>{ "-" } : args);
+    }
 
-    Parser parser(tokens, true);
-    parser.parse(); // Call the S() function to start parsing
+    string input;
+    input = mainMenu();
+    console.clear();
+    compile(input, true);
+    console.flush();
 
     return 0;
 }
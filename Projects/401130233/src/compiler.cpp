@@ -2,11 +2,34 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <iomanip>
 #include <string>
 #include <cctype>
-#include <unordered_set>
 #include <unordered_map>
 #include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SIMPLE_X86_KERNELS 1
+#endif
 
 // --------------------------------------------------------------------------
 // Token Types and Token Structure
@@ -210,6 +233,7 @@ private:
 
 class ASTNode {
 public:
+    int line = 0;  // first source line of a statement, set by the parser
     virtual ~ASTNode() = default;
     virtual void print(int indent = 0) const = 0;
 };
@@ -223,6 +247,7 @@ class ProgramNode : public ASTNode {
 public:
     std::vector<std::unique_ptr<ASTNode>> varDecls;
     std::unique_ptr<ASTNode> block;
+    int slotCount = 0;  // set by the semantic analyzer
 
     ProgramNode(std::vector<std::unique_ptr<ASTNode>> vars, std::unique_ptr<ASTNode> blk)
         : varDecls(std::move(vars)), block(std::move(blk)) {}
@@ -274,7 +299,8 @@ public:
 class IntLiteralNode : public ASTNode {
 public:
     std::string value;
-    IntLiteralNode(const std::string& val) : value(val) {}
+    long long number;  // parsed once, in range
+    IntLiteralNode(const std::string& val, long long number) : value(val), number(number) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -285,6 +311,7 @@ public:
 class IdentifierNode : public ASTNode {
 public:
     std::string name;
+    int slot = -1;  // declaration index, resolved by the semantic analyzer
     IdentifierNode(const std::string& name) : name(name) {}
     
     void print(int indent = 0) const override {
@@ -308,6 +335,7 @@ public:
 class ReadNode : public ASTNode {
 public:
     std::string identifier;
+    int slot = -1;
     ReadNode(const std::string& id) : identifier(id) {}
     
     void print(int indent = 0) const override {
@@ -316,6 +344,53 @@ public:
     }
 };
 
+class AssignNode : public ASTNode {
+public:
+    std::string identifier;
+    int slot = -1;
+    std::unique_ptr<ASTNode> expr;
+    AssignNode(const std::string& id, std::unique_ptr<ASTNode> expr)
+        : identifier(id), expr(std::move(expr)) {}
+    
+    void print(int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "Assign: " << identifier << "\n";
+        if (expr) expr->print(indent + 1);
+    }
+};
+
+// If and Iteration share this shape: a comparison (a BinaryExprNode with
+// op "<", ">" or "==") guarding a single statement
+class IfNode : public ASTNode {
+public:
+    std::unique_ptr<ASTNode> condition;
+    std::unique_ptr<ASTNode> body;
+    IfNode(std::unique_ptr<ASTNode> condition, std::unique_ptr<ASTNode> body)
+        : condition(std::move(condition)), body(std::move(body)) {}
+    
+    void print(int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "If\n";
+        if (condition) condition->print(indent + 1);
+        if (body) body->print(indent + 1);
+    }
+};
+
+class IterationNode : public ASTNode {
+public:
+    std::unique_ptr<ASTNode> condition;
+    std::unique_ptr<ASTNode> body;
+    IterationNode(std::unique_ptr<ASTNode> condition, std::unique_ptr<ASTNode> body)
+        : condition(std::move(condition)), body(std::move(body)) {}
+    
+    void print(int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "Iteration\n";
+        if (condition) condition->print(indent + 1);
+        if (body) body->print(indent + 1);
+    }
+};
+
 class BlockNode : public ASTNode {
 public:
     std::vector<std::unique_ptr<ASTNode>> statements;
@@ -340,6 +415,8 @@ class Parser {
 public:
     Parser(const std::vector<Token>& tokens) : tokens(tokens), current(0) {}
     
+    int errorCount = 0;
+    
     std::unique_ptr<ASTNode> parse() {
         if (!match(TokenType::KW_PROGRAM)) {
             error(peek(), "Expected 'Program' at start");
@@ -389,6 +466,7 @@ private:
     }
     
     void error(const Token& token, const std::string& message) {
+        errorCount++;
         std::cerr << "Syntax Error at line " << token.line << ", col " << token.column
                   << ": " << message << " (found '" << token.lexeme << "')\n";
     }
@@ -435,16 +513,38 @@ private:
     
     bool isStateStart(TokenType type) {
         return type == TokenType::KW_PRINT || type == TokenType::KW_READ ||
-               type == TokenType::KW_START;
+               type == TokenType::KW_START || type == TokenType::KW_PUT ||
+               type == TokenType::KW_IF || type == TokenType::KW_ITERATION;
     }
     
     std::unique_ptr<ASTNode> parseState() {
+        int line = peek().line;
+        auto state = parseStatement();
+        if (state) state->line = line;
+        return state;
+    }
+    
+    std::unique_ptr<ASTNode> parseStatement() {
         if (check(TokenType::KW_PRINT)) {
             return parseOut();
         } else if (check(TokenType::KW_READ)) {
             return parseIn();
         } else if (check(TokenType::KW_START)) {
             return parseBlocks();
+        } else if (check(TokenType::KW_PUT)) {
+            return parseAssign();
+        } else if (check(TokenType::KW_IF)) {
+            advance();
+            auto condition = parseCondition("If");
+            auto body = parseBraced("If");
+            if (!condition || !body) return nullptr;
+            return std::make_unique<IfNode>(std::move(condition), std::move(body));
+        } else if (check(TokenType::KW_ITERATION)) {
+            advance();
+            auto condition = parseCondition("Iteration");
+            auto body = parseBraced("Iteration");
+            if (!condition || !body) return nullptr;
+            return std::make_unique<IterationNode>(std::move(condition), std::move(body));
         } else {
             error(peek(), "Unexpected statement");
             advance();
@@ -492,6 +592,61 @@ private:
         return std::make_unique<ReadNode>(id);
     }
     
+    std::unique_ptr<ASTNode> parseAssign() {
+        if (!match(TokenType::KW_PUT)) return nullptr;
+        if (!check(TokenType::IDENTIFIER)) {
+            error(peek(), "Expected identifier after Put");
+            return nullptr;
+        }
+        std::string id = advance().lexeme;
+        if (!match(TokenType::OP_ASSIGN)) {
+            error(peek(), "Expected = after identifier");
+            return nullptr;
+        }
+        auto expr = parseExpr();
+        if (!match(TokenType::DELIM_SEMICOLON)) {
+            error(peek(), "Expected ; after Put");
+            return nullptr;
+        }
+        if (!expr) return nullptr;
+        return std::make_unique<AssignNode>(id, std::move(expr));
+    }
+    
+    // ( <EXPR> <O> <EXPR> )
+    std::unique_ptr<ASTNode> parseCondition(const std::string& keyword) {
+        if (!match(TokenType::DELIM_LPAREN)) {
+            error(peek(), "Expected ( after " + keyword);
+            return nullptr;
+        }
+        auto left = parseExpr();
+        if (!check(TokenType::OP_LT) && !check(TokenType::OP_GT) && !check(TokenType::OP_EQEQ)) {
+            error(peek(), "Expected <, > or == in " + keyword + " condition");
+            return nullptr;
+        }
+        std::string op = advance().lexeme;
+        auto right = parseExpr();
+        if (!match(TokenType::DELIM_RPAREN)) {
+            error(peek(), "Expected ) after " + keyword + " condition");
+            return nullptr;
+        }
+        if (!left || !right) return nullptr;
+        return std::make_unique<BinaryExprNode>(op, std::move(left), std::move(right));
+    }
+    
+    // { <STATE> }
+    std::unique_ptr<ASTNode> parseBraced(const std::string& keyword) {
+        if (!match(TokenType::DELIM_LBRACE)) {
+            error(peek(), "Expected { after " + keyword + " condition");
+            return nullptr;
+        }
+        auto state = parseState();
+        if (!match(TokenType::DELIM_RBRACE)) {
+            error(peek(), "Expected } after " + keyword + " body");
+            return nullptr;
+        }
+        return state;
+    }
+    
     std::unique_ptr<ASTNode> parseExpr() {
         auto node = parseR();
         while (check(TokenType::OP_PLUS) || check(TokenType::OP_MINUS)) {
@@ -508,8 +663,14 @@ private:
             return std::make_unique<IdentifierNode>(id);
         }
         if (check(TokenType::INTEGER)) {
-            std::string val = advance().lexeme;
-            return std::make_unique<IntLiteralNode>(val);
+            const Token& token = advance();
+            errno = 0;
+            long long number = std::strtoll(token.lexeme.c_str(), nullptr, 10);
+            if (errno == ERANGE) {
+                error(token, "Integer literal out of range");
+                return nullptr;
+            }
+            return std::make_unique<IntLiteralNode>(token.lexeme, number);
         }
         error(peek(), "Expected identifier or number");
         return nullptr;
@@ -524,13 +685,24 @@ class SemanticAnalyzer {
 public:
     SemanticAnalyzer(ASTNode* root) : root(root) {}
     
+    int errorCount = 0;
+    
     void analyze() {
         analyzeNode(root);
     }
     
 private:
     ASTNode* root;
-    std::unordered_set<std::string> symbolTable;
+    std::unordered_map<std::string, int> symbolTable;  // name -> slot
+    
+    // Slot of a declared variable, or -1 (with an error) if undeclared
+    int resolve(const std::string& name, const std::string& context) {
+        auto it = symbolTable.find(name);
+        if (it != symbolTable.end()) return it->second;
+        errorCount++;
+        std::cerr << "Semantic Error: " << context << " variable '" << name << "'\n";
+        return -1;
+    }
     
     void analyzeNode(ASTNode* node) {
         if (!node) return;
@@ -540,13 +712,16 @@ private:
             for (const auto& varDecl : program->varDecls) {
                 if (auto var = dynamic_cast<VarDeclNode*>(varDecl.get())) {
                     if (symbolTable.count(var->identifier)) {
+                        errorCount++;
                         std::cerr << "Semantic Error: Duplicate variable '"
                                   << var->identifier << "'\n";
                     } else {
-                        symbolTable.insert(var->identifier);
+                        int slot = static_cast<int>(symbolTable.size());
+                        symbolTable[var->identifier] = slot;
                     }
                 }
             }
+            program->slotCount = static_cast<int>(symbolTable.size());
             // Process main block
             analyzeNode(program->block.get());
             return;
@@ -560,18 +735,12 @@ private:
         }
         
         if (auto id = dynamic_cast<IdentifierNode*>(node)) {
-            if (!symbolTable.count(id->name)) {
-                std::cerr << "Semantic Error: Undeclared variable '"
-                          << id->name << "'\n";
-            }
+            id->slot = resolve(id->name, "Undeclared");
             return;
         }
         
         if (auto read = dynamic_cast<ReadNode*>(node)) {
-            if (!symbolTable.count(read->identifier)) {
-                std::cerr << "Semantic Error: Reading undeclared variable '"
-                          << read->identifier << "'\n";
-            }
+            read->slot = resolve(read->identifier, "Reading undeclared");
             return;
         }
         
@@ -585,21 +754,2206 @@ private:
             analyzeNode(print->expr.get());
             return;
         }
+        
+        if (auto assign = dynamic_cast<AssignNode*>(node)) {
+            assign->slot = resolve(assign->identifier, "Assigning undeclared");
+            analyzeNode(assign->expr.get());
+            return;
+        }
+        
+        if (auto ifNode = dynamic_cast<IfNode*>(node)) {
+            analyzeNode(ifNode->condition.get());
+            analyzeNode(ifNode->body.get());
+            return;
+        }
+        
+        if (auto loop = dynamic_cast<IterationNode*>(node)) {
+            analyzeNode(loop->condition.get());
+            analyzeNode(loop->body.get());
+            return;
+        }
     }
 };
 
 // --------------------------------------------------------------------------
-// Main Function
+// AST Interpreter (Phase 4)
 // --------------------------------------------------------------------------
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <source_file>\n";
-        return 1;
+// Integer arithmetic wraps around on overflow, the same in every back end
+long long wrapAdd(long long a, long long b) {
+    return static_cast<long long>(static_cast<unsigned long long>(a) + static_cast<unsigned long long>(b));
+}
+
+long long wrapSub(long long a, long long b) {
+    return static_cast<long long>(static_cast<unsigned long long>(a) - static_cast<unsigned long long>(b));
+}
+
+bool compare(const std::string& op, long long left, long long right) {
+    if (op == "<") return left < right;
+    if (op == ">") return left > right;
+    return left == right;
+}
+
+class Interpreter {
+public:
+    Interpreter(std::istream& in, std::ostream& out) : in(in), out(out) {}
+    virtual ~Interpreter() = default;
+    
+    void run(ASTNode* root) {
+        auto program = dynamic_cast<ProgramNode*>(root);
+        if (!program) return;
+        // Declared variables start out as 0
+        for (const auto& varDecl : program->varDecls) {
+            if (auto var = dynamic_cast<VarDeclNode*>(varDecl.get()))
+                variables[var->identifier] = 0;
+        }
+        execute(program->block.get());
     }
     
-    Lexer lexer(argv[1]);
+protected:
+    std::istream& in;
+    std::ostream& out;
+    std::unordered_map<std::string, long long> variables;
+    
+    void execute(ASTNode* node) {
+        if (auto block = dynamic_cast<BlockNode*>(node)) {
+            for (const auto& stmt : block->statements) execute(stmt.get());
+        } else if (auto assign = dynamic_cast<AssignNode*>(node)) {
+            variables[assign->identifier] = evaluate(assign->expr.get());
+        } else if (auto print = dynamic_cast<PrintNode*>(node)) {
+            out << evaluate(print->expr.get()) << '\n';
+        } else if (auto read = dynamic_cast<ReadNode*>(node)) {
+            long long value = 0;
+            in >> value;
+            variables[read->identifier] = value;
+        } else if (auto ifNode = dynamic_cast<IfNode*>(node)) {
+            if (evaluate(ifNode->condition.get())) execute(ifNode->body.get());
+        } else if (auto loop = dynamic_cast<IterationNode*>(node)) {
+            executeLoop(loop);
+        }
+    }
+    
+    // Overridden by TieredExecutor to move hot loops to bytecode
+    virtual void executeLoop(IterationNode* loop) {
+        while (evaluate(loop->condition.get())) execute(loop->body.get());
+    }
+    
+    // Comparisons evaluate to 1 or 0
+    long long evaluate(ASTNode* node) {
+        if (auto literal = dynamic_cast<IntLiteralNode*>(node)) {
+            return literal->number;
+        }
+        if (auto id = dynamic_cast<IdentifierNode*>(node)) {
+            return variables[id->name];
+        }
+        if (auto binExpr = dynamic_cast<BinaryExprNode*>(node)) {
+            long long left = evaluate(binExpr->left.get());
+            long long right = evaluate(binExpr->right.get());
+            if (binExpr->op == "+") return wrapAdd(left, right);
+            if (binExpr->op == "-") return wrapSub(left, right);
+            return compare(binExpr->op, left, right);
+        }
+        return 0;
+    }
+};
+
+// --------------------------------------------------------------------------
+// C Code Generator (Phase 5)
+// --------------------------------------------------------------------------
+
+// Emits a self-contained C translation unit: variables become locals of
+// main(), Iteration becomes while, and Read/Print use block-buffered stdio.
+class CCodeGenerator {
+public:
+    void generate(ASTNode* root, std::ostream& out) {
+        auto program = dynamic_cast<ProgramNode*>(root);
+        if (!program) return;
+        out << runtime;
+        out << "int main(void) {\n";
+        for (const auto& varDecl : program->varDecls) {
+            if (auto var = dynamic_cast<VarDeclNode*>(varDecl.get()))
+                out << "    long long " << cName(var->identifier) << " = 0;\n";
+        }
+        emitStatement(program->block.get(), out, 1);
+        out << "    flush_output();\n";
+        out << "    return 0;\n";
+        out << "}\n";
+    }
+    
+private:
+    // Read/Print support; signed overflow is avoided by going through unsigned
+    static constexpr const char* runtime = R"(/* Generated by the Simple compiler */
+#include <stdio.h>
+
+#define ADD(a, b) ((long long)((unsigned long long)(a) + (unsigned long long)(b)))
+#define SUB(a, b) ((long long)((unsigned long long)(a) - (unsigned long long)(b)))
+
+static char input[1 << 16];
+static size_t inputLength = 0, inputPos = 0;
+static int inputFailed = 0;
+static char output[1 << 16];
+static size_t outputLength = 0;
+
+static void flush_output(void) {
+    fwrite(output, 1, outputLength, stdout);
+    fflush(stdout);
+    outputLength = 0;
+}
+
+static int next_char(void) {
+    if (inputPos == inputLength) {
+        inputLength = fread(input, 1, sizeof(input), stdin);
+        inputPos = 0;
+        if (inputLength == 0) return EOF;
+    }
+    return (unsigned char)input[inputPos++];
+}
+
+/* Like std::cin >> value: 0 on bad input, LLONG_MAX or LLONG_MIN on
+   overflow, and after either every later read fails too */
+static long long read_int(void) {
+    int c, negative = 0, overflow = 0;
+    unsigned long long value = 0, limit;
+    if (outputLength > 0) flush_output();
+    if (inputFailed) return 0;
+    do c = next_char(); while (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v');
+    if (c == '-' || c == '+') {
+        negative = c == '-';
+        c = next_char();
+    }
+    if (c < '0' || c > '9') {
+        inputFailed = 1;
+        return 0;
+    }
+    limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+    while (c >= '0' && c <= '9') {
+        unsigned digit = (unsigned)(c - '0');
+        if (value > (limit - digit) / 10) overflow = 1;
+        else value = value * 10 + digit;
+        c = next_char();
+    }
+    if (c != EOF) inputPos--;
+    if (overflow) {
+        inputFailed = 1;
+        value = limit;
+    }
+    return negative ? (long long)(0 - value) : (long long)value;
+}
+
+static void print_int(long long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long long magnitude = value < 0 ? 0 - (unsigned long long)value : (unsigned long long)value;
+    if (outputLength + sizeof(digits) > sizeof(output)) flush_output();
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) output[outputLength++] = '-';
+    while (n > 0) output[outputLength++] = digits[--n];
+    output[outputLength++] = '\n';
+}
+
+)";
+    
+    // Prefixed so Simple identifiers never collide with C keywords
+    static std::string cName(const std::string& identifier) {
+        return "v_" + identifier;
+    }
+    
+    static void indentTo(std::ostream& out, int indent) {
+        for (int i = 0; i < indent; ++i) out << "    ";
+    }
+    
+    void emitStatement(ASTNode* node, std::ostream& out, int indent) {
+        if (auto block = dynamic_cast<BlockNode*>(node)) {
+            for (const auto& stmt : block->statements) emitStatement(stmt.get(), out, indent);
+        } else if (auto assign = dynamic_cast<AssignNode*>(node)) {
+            indentTo(out, indent);
+            out << cName(assign->identifier) << " = " << emitExpr(assign->expr.get()) << ";\n";
+        } else if (auto print = dynamic_cast<PrintNode*>(node)) {
+            indentTo(out, indent);
+            out << "print_int(" << emitExpr(print->expr.get()) << ");\n";
+        } else if (auto read = dynamic_cast<ReadNode*>(node)) {
+            indentTo(out, indent);
+            out << cName(read->identifier) << " = read_int();\n";
+        } else if (auto ifNode = dynamic_cast<IfNode*>(node)) {
+            indentTo(out, indent);
+            out << "if (" << emitExpr(ifNode->condition.get()) << ") {\n";
+            emitStatement(ifNode->body.get(), out, indent + 1);
+            indentTo(out, indent);
+            out << "}\n";
+        } else if (auto loop = dynamic_cast<IterationNode*>(node)) {
+            indentTo(out, indent);
+            out << "while (" << emitExpr(loop->condition.get()) << ") {\n";
+            emitStatement(loop->body.get(), out, indent + 1);
+            indentTo(out, indent);
+            out << "}\n";
+        }
+    }
+    
+    std::string emitExpr(ASTNode* node) {
+        if (auto literal = dynamic_cast<IntLiteralNode*>(node)) {
+            return literal->value + "LL";
+        }
+        if (auto id = dynamic_cast<IdentifierNode*>(node)) {
+            return cName(id->name);
+        }
+        if (auto binExpr = dynamic_cast<BinaryExprNode*>(node)) {
+            std::string left = emitExpr(binExpr->left.get());
+            std::string right = emitExpr(binExpr->right.get());
+            if (binExpr->op == "+") return "ADD(" + left + ", " + right + ")";
+            if (binExpr->op == "-") return "SUB(" + left + ", " + right + ")";
+            return left + " " + binExpr->op + " " + right;
+        }
+        return "0";
+    }
+};
+
+// --------------------------------------------------------------------------
+// Bytecode (Phase 6)
+// --------------------------------------------------------------------------
+
+// A small stack machine over the slots resolved by the semantic analyzer.
+// Comparisons push 1 or 0; JumpIfFalse pops the condition.
+enum class OpCode : unsigned char {
+    Const,        // push operand
+    Load,         // push slots[operand]
+    Store,        // slots[operand] = pop
+    Add,
+    Sub,
+    Less,
+    Greater,
+    Equal,
+    Jump,         // pc = operand
+    JumpIfFalse,  // if (!pop) pc = operand
+    Read,         // slots[operand] = next input integer
+    Print,        // print pop
+    Halt,
+    
+    // Superinstructions, formed from the ops above by SuperinstructionPass.
+    // They also use the a and b fields of Instruction.
+    AddSlotImm,          // slots[a] += constants[operand]
+    AddSlots,            // slots[a] = slots[b] + slots[operand]
+    SubSlots,            // slots[a] = slots[b] - slots[operand]
+    StoreImm,            // slots[a] = constants[operand]
+    Move,                // slots[a] = slots[operand]
+    PrintSlot,           // print slots[a]
+    AddTopSlot,          // top += slots[operand]
+    SubTopSlot,          // top -= slots[operand]
+    AddTopImm,           // top += constants[operand]
+    JumpUnlessLessImm,   // if (!(slots[a] < constants[operand])) pc = b
+    JumpUnlessGreaterImm,
+    JumpUnlessEqualImm,
+    JumpUnlessLess,      // if (!(slots[a] < slots[operand])) pc = b
+    JumpUnlessGreater,
+    JumpUnlessEqual
+};
+
+const OpCode lastOpCode = OpCode::JumpUnlessEqual;
+
+const char* opCodeName(OpCode op) {
+    static const char* const names[] = {
+        "Const", "Load", "Store", "Add", "Sub", "Less", "Greater", "Equal", "Jump",
+        "JumpIfFalse", "Read", "Print", "Halt", "AddSlotImm", "AddSlots", "SubSlots",
+        "StoreImm", "Move", "PrintSlot", "AddTopSlot", "SubTopSlot", "AddTopImm",
+        "JumpUnlessLessImm", "JumpUnlessGreaterImm", "JumpUnlessEqualImm",
+        "JumpUnlessLess", "JumpUnlessGreater", "JumpUnlessEqual"
+    };
+    return names[static_cast<int>(op)];
+}
+
+// Integer literals live in the constant pool and are referenced by index,
+// so every instruction is 16 bytes
+struct Instruction {
+    OpCode op;
+    int operand;
+    int a = 0;
+    int b = 0;
+};
+
+// Debug line table entry: code from pc up to the next entry belongs to line
+struct LineEntry {
+    unsigned pc;
+    unsigned line;
+};
+
+struct Bytecode {
+    std::vector<Instruction> code;
+    std::vector<long long> constants;
+    std::vector<LineEntry> lines;
+    int maxStack = 0;
+    std::unordered_map<long long, int> constantIndex;
+    
+    int addConstant(long long value) {
+        auto it = constantIndex.find(value);
+        if (it != constantIndex.end()) return it->second;
+        constants.push_back(value);
+        return constantIndex[value] = static_cast<int>(constants.size() - 1);
+    }
+};
+
+// What the VM runs: a Bytecode in memory or a mapped image
+struct BytecodeView {
+    const Instruction* code;
+    size_t size;
+    const long long* constants;
+    int maxStack;
+    
+    BytecodeView(const Bytecode& bytecode)
+        : code(bytecode.code.data()), size(bytecode.code.size()),
+          constants(bytecode.constants.data()), maxStack(bytecode.maxStack) {}
+    BytecodeView(const Instruction* code, size_t size, const long long* constants, int maxStack)
+        : code(code), size(size), constants(constants), maxStack(maxStack) {}
+};
+
+class BytecodeCompiler {
+public:
+    // Compiles one statement (a loop, a block or the whole program body)
+    Bytecode compile(ASTNode* statement) {
+        result = Bytecode();
+        depth = 0;
+        emitStatement(statement);
+        emit(OpCode::Halt);
+        return std::move(result);
+    }
+    
+private:
+    Bytecode result;
+    int depth = 0;
+    
+    size_t emit(OpCode op, int operand = 0) {
+        result.code.push_back({op, operand, 0, 0});
+        return result.code.size() - 1;
+    }
+    
+    void markLine(int line) {
+        if (line <= 0 || (!result.lines.empty() && result.lines.back().line == static_cast<unsigned>(line))) return;
+        unsigned pc = static_cast<unsigned>(result.code.size());
+        if (!result.lines.empty() && result.lines.back().pc == pc) result.lines.pop_back();
+        result.lines.push_back({pc, static_cast<unsigned>(line)});
+    }
+    
+    void push() {
+        if (++depth > result.maxStack) result.maxStack = depth;
+    }
+    
+    void patch(size_t jump) {
+        result.code[jump].operand = static_cast<int>(result.code.size());
+    }
+    
+    void emitStatement(ASTNode* node) {
+        if (!dynamic_cast<BlockNode*>(node)) markLine(node->line);
+        if (auto block = dynamic_cast<BlockNode*>(node)) {
+            for (const auto& stmt : block->statements) emitStatement(stmt.get());
+        } else if (auto assign = dynamic_cast<AssignNode*>(node)) {
+            emitExpr(assign->expr.get());
+            emit(OpCode::Store, assign->slot);
+            depth--;
+        } else if (auto print = dynamic_cast<PrintNode*>(node)) {
+            emitExpr(print->expr.get());
+            emit(OpCode::Print);
+            depth--;
+        } else if (auto read = dynamic_cast<ReadNode*>(node)) {
+            emit(OpCode::Read, read->slot);
+        } else if (auto ifNode = dynamic_cast<IfNode*>(node)) {
+            emitExpr(ifNode->condition.get());
+            size_t skip = emit(OpCode::JumpIfFalse);
+            depth--;
+            emitStatement(ifNode->body.get());
+            patch(skip);
+        } else if (auto loop = dynamic_cast<IterationNode*>(node)) {
+            size_t head = result.code.size();
+            emitExpr(loop->condition.get());
+            size_t exit = emit(OpCode::JumpIfFalse);
+            depth--;
+            emitStatement(loop->body.get());
+            markLine(loop->line);
+            emit(OpCode::Jump, static_cast<int>(head));
+            patch(exit);
+        }
+    }
+    
+    void emitExpr(ASTNode* node) {
+        if (auto literal = dynamic_cast<IntLiteralNode*>(node)) {
+            emit(OpCode::Const, result.addConstant(literal->number));
+            push();
+        } else if (auto id = dynamic_cast<IdentifierNode*>(node)) {
+            emit(OpCode::Load, id->slot);
+            push();
+        } else if (auto binExpr = dynamic_cast<BinaryExprNode*>(node)) {
+            emitExpr(binExpr->left.get());
+            emitExpr(binExpr->right.get());
+            if (binExpr->op == "+") emit(OpCode::Add);
+            else if (binExpr->op == "-") emit(OpCode::Sub);
+            else if (binExpr->op == "<") emit(OpCode::Less);
+            else if (binExpr->op == ">") emit(OpCode::Greater);
+            else emit(OpCode::Equal);
+            depth--;
+        }
+    }
+};
+
+enum class VMStatus {
+    Halted,
+    OutOfBudget,      // preempted at a loop back edge; resume later
+    WaitingForInput   // Read found no input yet; resume re-executes it
+};
+
+// Where a stopped program resumes
+struct VMRegisters {
+    size_t pc = 0;
+    size_t depth = 0;  // operand stack height
+};
+
+// The dispatch loop shared by every way of running bytecode. `io` supplies
+// bool read(long long&), which may decline when no input is ready, and
+// print(long long). The budget is checked only on backward jumps: code
+// between two of them is finite, so it bounds how long a slice runs
+// without costing anything in straight-line code.
+template <bool Profiling, typename IO>
+VMStatus executeBytecode(const BytecodeView& bytecode, long long* slots, long long* stack,
+                         VMRegisters& regs, IO& io, long long budget, long long& dispatched,
+                         long long* counts = nullptr) {
+    long long* sp = stack + regs.depth;
+    const Instruction* code = bytecode.code;
+    const long long* constants = bytecode.constants;
+    size_t pc = regs.pc;
+    long long count = 0;
+    VMStatus status = VMStatus::Halted;
+    for (;;) {
+        if (Profiling) counts[pc]++;
+        const Instruction& instr = code[pc++];
+        count++;
+        switch (instr.op) {
+            case OpCode::Const: *sp++ = constants[instr.operand]; break;
+            case OpCode::Load: *sp++ = slots[instr.operand]; break;
+            case OpCode::Store: slots[instr.operand] = *--sp; break;
+            case OpCode::Add: sp--; sp[-1] = wrapAdd(sp[-1], sp[0]); break;
+            case OpCode::Sub: sp--; sp[-1] = wrapSub(sp[-1], sp[0]); break;
+            case OpCode::Less: sp--; sp[-1] = sp[-1] < sp[0]; break;
+            case OpCode::Greater: sp--; sp[-1] = sp[-1] > sp[0]; break;
+            case OpCode::Equal: sp--; sp[-1] = sp[-1] == sp[0]; break;
+            case OpCode::Jump:
+                pc = instr.operand;
+                if (count >= budget) {
+                    status = VMStatus::OutOfBudget;
+                    goto stop;
+                }
+                break;
+            case OpCode::JumpIfFalse:
+                if (!*--sp) pc = instr.operand;
+                break;
+            case OpCode::Read:
+                if (!io.read(slots[instr.operand])) {
+                    pc--;
+                    count--;
+                    status = VMStatus::WaitingForInput;
+                    goto stop;
+                }
+                break;
+            case OpCode::Print: io.print(*--sp); break;
+            case OpCode::Halt:
+                pc--;
+                goto stop;
+            case OpCode::AddSlotImm: slots[instr.a] = wrapAdd(slots[instr.a], constants[instr.operand]); break;
+            case OpCode::AddSlots: slots[instr.a] = wrapAdd(slots[instr.b], slots[instr.operand]); break;
+            case OpCode::SubSlots: slots[instr.a] = wrapSub(slots[instr.b], slots[instr.operand]); break;
+            case OpCode::StoreImm: slots[instr.a] = constants[instr.operand]; break;
+            case OpCode::Move: slots[instr.a] = slots[instr.operand]; break;
+            case OpCode::PrintSlot: io.print(slots[instr.a]); break;
+            case OpCode::AddTopSlot: sp[-1] = wrapAdd(sp[-1], slots[instr.operand]); break;
+            case OpCode::SubTopSlot: sp[-1] = wrapSub(sp[-1], slots[instr.operand]); break;
+            case OpCode::AddTopImm: sp[-1] = wrapAdd(sp[-1], constants[instr.operand]); break;
+            case OpCode::JumpUnlessLessImm:
+                if (!(slots[instr.a] < constants[instr.operand])) pc = instr.b;
+                break;
+            case OpCode::JumpUnlessGreaterImm:
+                if (!(slots[instr.a] > constants[instr.operand])) pc = instr.b;
+                break;
+            case OpCode::JumpUnlessEqualImm:
+                if (slots[instr.a] != constants[instr.operand]) pc = instr.b;
+                break;
+            case OpCode::JumpUnlessLess:
+                if (!(slots[instr.a] < slots[instr.operand])) pc = instr.b;
+                break;
+            case OpCode::JumpUnlessGreater:
+                if (!(slots[instr.a] > slots[instr.operand])) pc = instr.b;
+                break;
+            case OpCode::JumpUnlessEqual:
+                if (slots[instr.a] != slots[instr.operand]) pc = instr.b;
+                break;
+        }
+    }
+stop:
+    regs.pc = pc;
+    regs.depth = static_cast<size_t>(sp - stack);
+    dispatched += count;
+    return status;
+}
+
+// Runs bytecode to completion against streams
+class BytecodeVM {
+public:
+    BytecodeVM(std::istream& in, std::ostream& out) : io{in, out} {}
+    
+    long long dispatched = 0;  // instructions executed
+    
+    void run(const BytecodeView& bytecode, long long* slots) {
+        std::vector<long long> stack(bytecode.maxStack + 1);
+        VMRegisters regs;
+        executeBytecode<false>(bytecode, slots, stack.data(), regs, io, LLONG_MAX, dispatched);
+    }
+    
+    // Runs until the program halts or about `budget` instructions have
+    // executed, and returns how often each instruction ran
+    std::vector<long long> profile(const BytecodeView& bytecode, long long* slots, long long budget) {
+        std::vector<long long> counts(bytecode.size, 0);
+        std::vector<long long> stack(bytecode.maxStack + 1);
+        VMRegisters regs;
+        executeBytecode<true>(bytecode, slots, stack.data(), regs, io, budget, dispatched, counts.data());
+        return counts;
+    }
+    
+private:
+    struct StreamIO {
+        std::istream& in;
+        std::ostream& out;
+        
+        bool read(long long& value) {
+            value = 0;
+            in >> value;
+            return true;
+        }
+        
+        void print(long long value) {
+            out << value << '\n';
+        }
+    } io;
+};
+
+// --------------------------------------------------------------------------
+// Superinstructions
+// --------------------------------------------------------------------------
+
+// Fuses common instruction sequences into single superinstructions. Which
+// fusions pay off is decided from a profile: each rule is enabled only if
+// the dispatches it would remove reach `minShare` of all profiled
+// dispatches. A sequence is never fused across a jump target.
+class SuperinstructionPass {
+public:
+    struct RuleReport {
+        std::string name;
+        long long sites = 0;
+        long long saved = 0;  // profiled dispatches removed
+        bool enabled = false;
+    };
+    
+    std::vector<RuleReport> report;
+    
+    Bytecode run(const Bytecode& input, const std::vector<long long>& counts, double minShare = 0.01) {
+        const auto& code = input.code;
+        std::vector<bool> isTarget(code.size() + 1, false);
+        for (const auto& instr : code) {
+            if (instr.op == OpCode::Jump || instr.op == OpCode::JumpIfFalse)
+                isTarget[instr.operand] = true;
+        }
+        
+        // Plan with every rule, then keep the ones that pay off
+        long long total = 0;
+        for (long long c : counts) total += c;
+        std::vector<bool> enabled(rules().size(), true);
+        report.assign(rules().size(), {});
+        for (size_t r = 0; r < rules().size(); ++r) report[r].name = rules()[r].name;
+        for (size_t pc = 0; pc < code.size();) {
+            int r = match(code, pc, isTarget, enabled);
+            if (r < 0) {
+                pc++;
+                continue;
+            }
+            report[r].sites++;
+            report[r].saved += counts[pc] * (rules()[r].pattern.size() - 1);
+            pc += rules()[r].pattern.size();
+        }
+        for (size_t r = 0; r < rules().size(); ++r) {
+            enabled[r] = report[r].saved > 0 && report[r].saved >= minShare * total;
+            report[r].enabled = enabled[r];
+        }
+        
+        // Keeps the constant pool; fusing may add negated steps to it
+        Bytecode output = input;
+        output.code.clear();
+        output.lines.clear();
+        std::vector<int> newIndex(code.size() + 1, 0);
+        for (size_t pc = 0; pc < code.size();) {
+            newIndex[pc] = static_cast<int>(output.code.size());
+            int r = match(code, pc, isTarget, enabled);
+            if (r < 0) {
+                output.code.push_back(code[pc++]);
+                continue;
+            }
+            output.code.push_back(rules()[r].fuse(&code[pc], output));
+            for (size_t i = 1; i < rules()[r].pattern.size(); ++i) newIndex[pc + i] = newIndex[pc];
+            pc += rules()[r].pattern.size();
+        }
+        newIndex[code.size()] = static_cast<int>(output.code.size());
+        for (auto& instr : output.code) {
+            if (instr.op == OpCode::Jump || instr.op == OpCode::JumpIfFalse)
+                instr.operand = newIndex[instr.operand];
+            else if (instr.op >= OpCode::JumpUnlessLessImm)  // the fused branches come last
+                instr.b = newIndex[instr.b];
+        }
+        for (const auto& entry : input.lines) {
+            unsigned pc = static_cast<unsigned>(newIndex[entry.pc]);
+            if (!output.lines.empty() && output.lines.back().pc == pc) output.lines.pop_back();
+            output.lines.push_back({pc, entry.line});
+        }
+        return output;
+    }
+    
+private:
+    struct Rule {
+        const char* name;
+        std::vector<OpCode> pattern;
+        bool (*accepts)(const Instruction* seq);
+        Instruction (*fuse)(const Instruction* seq, Bytecode& out);
+    };
+    
+    static bool any(const Instruction*) { return true; }
+    
+    static OpCode jumpUnless(OpCode compare, bool immediate) {
+        if (compare == OpCode::Less) return immediate ? OpCode::JumpUnlessLessImm : OpCode::JumpUnlessLess;
+        if (compare == OpCode::Greater) return immediate ? OpCode::JumpUnlessGreaterImm : OpCode::JumpUnlessGreater;
+        return immediate ? OpCode::JumpUnlessEqualImm : OpCode::JumpUnlessEqual;
+    }
+    
+    // Longest patterns first; OpCode::Add in a pattern also matches Sub
+    // and a comparison matches any of the three
+    static const std::vector<Rule>& rules() {
+        using O = OpCode;
+        static const std::vector<Rule> table = {
+            {"add-imm-to-slot", {O::Load, O::Const, O::Add, O::Store},
+                [](const Instruction* s) { return s[0].operand == s[3].operand; },
+                [](const Instruction* s, Bytecode& out) {
+                    long long step = out.constants[s[1].operand];
+                    if (s[2].op == O::Sub) step = wrapSub(0, step);
+                    return Instruction{O::AddSlotImm, out.addConstant(step), s[0].operand, 0};
+                }},
+            {"add-slots", {O::Load, O::Load, O::Add, O::Store}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{s[2].op == O::Add ? O::AddSlots : O::SubSlots, s[1].operand,
+                                       s[3].operand, s[0].operand};
+                }},
+            {"compare-slot-imm-branch", {O::Load, O::Const, O::Less, O::JumpIfFalse}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{jumpUnless(s[2].op, true), s[1].operand,
+                                       s[0].operand, s[3].operand};
+                }},
+            {"compare-slots-branch", {O::Load, O::Load, O::Less, O::JumpIfFalse}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{jumpUnless(s[2].op, false), s[1].operand,
+                                       s[0].operand, s[3].operand};
+                }},
+            {"store-imm", {O::Const, O::Store}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{O::StoreImm, s[0].operand, s[1].operand, 0};
+                }},
+            {"move", {O::Load, O::Store}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{O::Move, s[0].operand, s[1].operand, 0};
+                }},
+            {"print-slot", {O::Load, O::Print}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{O::PrintSlot, 0, s[0].operand, 0};
+                }},
+            {"add-slot-to-top", {O::Load, O::Add}, any,
+                [](const Instruction* s, Bytecode&) {
+                    return Instruction{s[1].op == O::Add ? O::AddTopSlot : O::SubTopSlot, s[0].operand, 0, 0};
+                }},
+            {"add-imm-to-top", {O::Const, O::Add}, any,
+                [](const Instruction* s, Bytecode& out) {
+                    long long step = out.constants[s[0].operand];
+                    if (s[1].op == O::Sub) step = wrapSub(0, step);
+                    return Instruction{O::AddTopImm, out.addConstant(step), 0, 0};
+                }},
+        };
+        return table;
+    }
+    
+    static bool opMatches(OpCode pattern, OpCode op) {
+        if (pattern == OpCode::Add) return op == OpCode::Add || op == OpCode::Sub;
+        if (pattern == OpCode::Less)
+            return op == OpCode::Less || op == OpCode::Greater || op == OpCode::Equal;
+        return pattern == op;
+    }
+    
+    static int match(const std::vector<Instruction>& code, size_t pc,
+                     const std::vector<bool>& isTarget, const std::vector<bool>& enabled) {
+        for (size_t r = 0; r < rules().size(); ++r) {
+            const Rule& rule = rules()[r];
+            if (!enabled[r] || pc + rule.pattern.size() > code.size()) continue;
+            bool matches = true;
+            for (size_t i = 0; i < rule.pattern.size() && matches; ++i) {
+                matches = opMatches(rule.pattern[i], code[pc + i].op) && (i == 0 || !isTarget[pc + i]);
+            }
+            if (matches && rule.accepts(&code[pc])) return static_cast<int>(r);
+        }
+        return -1;
+    }
+};
+
+// Compiles the program body to bytecode, profiles a bounded training run
+// on empty input (its output is discarded) and fuses superinstructions
+// from that profile
+Bytecode compileFused(ProgramNode* program, SuperinstructionPass& pass, long long budget = 1000000) {
+    Bytecode plain = BytecodeCompiler().compile(program->block.get());
+    std::istringstream noInput;
+    std::ostringstream discarded;
+    std::vector<long long> slots(program->slotCount + 1, 0);
+    auto counts = BytecodeVM(noInput, discarded).profile(plain, slots.data(), budget);
+    return pass.run(plain, counts);
+}
+
+// Front end and fused bytecode for one source file; false after errors
+bool compileFile(const std::string& path, Bytecode& bytecode, int& slotCount) {
+    Lexer lexer(path);
     auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+    if (!ast || parser.errorCount > 0) return false;
+    SemanticAnalyzer analyzer(ast.get());
+    analyzer.analyze();
+    if (analyzer.errorCount > 0) return false;
+    auto program = dynamic_cast<ProgramNode*>(ast.get());
+    SuperinstructionPass pass;
+    bytecode = compileFused(program, pass);
+    slotCount = program->slotCount;
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// Bytecode Image
+// --------------------------------------------------------------------------
+
+// A compiled program as one file that is mapped and run in place. All
+// fields are little-endian and every section is 8-byte aligned and found
+// by its offset from the start of the file, so nothing depends on where
+// the file is mapped:
+//
+//   ImageHeader
+//   constant pool   constantCount int64 values
+//   instructions    instructionCount 16-byte Instruction records
+//   line table      lineCount LineEntry records, sorted by pc
+//   variable names  slotCount NUL-terminated names in declaration order
+struct ImageHeader {
+    char magic[4];  // "SMPB"
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t maxStack;
+    uint32_t constantCount, constantOffset;
+    uint32_t instructionCount, instructionOffset;
+    uint32_t lineCount, lineOffset;
+    uint32_t nameBytes, nameOffset;
+};
+
+const uint32_t imageVersion = 1;
+
+static_assert(sizeof(ImageHeader) == 48, "image header layout");
+static_assert(sizeof(Instruction) == 16 && offsetof(Instruction, operand) == 4 &&
+              offsetof(Instruction, a) == 8 && offsetof(Instruction, b) == 12,
+              "instructions are mapped straight from the image");
+static_assert(sizeof(LineEntry) == 8, "line table layout");
+
+// Checks everything the VM trusts: opcodes, slot, constant and jump
+// operands, and that the operand stack stays within maxStack on every path
+bool verifyBytecode(const BytecodeView& bytecode, size_t constantCount, int slotCount, std::string& error) {
+    const size_t size = bytecode.size;
+    auto fail = [&](size_t pc, const std::string& message) {
+        error = "instruction " + std::to_string(pc) + ": " + message;
+        return false;
+    };
+    if (size == 0) return fail(0, "empty code");
+    auto slotOk = [&](int slot) { return slot >= 0 && slot < slotCount; };
+    auto constantOk = [&](int index) { return index >= 0 && static_cast<size_t>(index) < constantCount; };
+    auto targetOk = [&](int target) { return target >= 0 && static_cast<size_t>(target) < size; };
+    
+    std::vector<int> depthAt(size, -1);
+    std::vector<size_t> worklist = {0};
+    depthAt[0] = 0;
+    while (!worklist.empty()) {
+        size_t pc = worklist.back();
+        worklist.pop_back();
+        const Instruction& instr = bytecode.code[pc];
+        if (instr.op > lastOpCode) return fail(pc, "bad opcode");
+        int depth = depthAt[pc];
+        int pops = 0, pushes = 0;
+        bool ok = true, fallsThrough = true, branches = false;
+        int target = 0;
+        switch (instr.op) {
+            case OpCode::Const: pushes = 1; ok = constantOk(instr.operand); break;
+            case OpCode::Load: pushes = 1; ok = slotOk(instr.operand); break;
+            case OpCode::Store: pops = 1; ok = slotOk(instr.operand); break;
+            case OpCode::Add: case OpCode::Sub:
+            case OpCode::Less: case OpCode::Greater: case OpCode::Equal:
+                pops = 2; pushes = 1; break;
+            case OpCode::Jump: branches = true; target = instr.operand; fallsThrough = false; break;
+            case OpCode::JumpIfFalse: pops = 1; branches = true; target = instr.operand; break;
+            case OpCode::Read: ok = slotOk(instr.operand); break;
+            case OpCode::Print: pops = 1; break;
+            case OpCode::Halt: fallsThrough = false; break;
+            case OpCode::AddSlotImm: case OpCode::StoreImm:
+                ok = slotOk(instr.a) && constantOk(instr.operand); break;
+            case OpCode::AddSlots: case OpCode::SubSlots:
+                ok = slotOk(instr.a) && slotOk(instr.b) && slotOk(instr.operand); break;
+            case OpCode::Move: ok = slotOk(instr.a) && slotOk(instr.operand); break;
+            case OpCode::PrintSlot: ok = slotOk(instr.a); break;
+            case OpCode::AddTopSlot: case OpCode::SubTopSlot:
+                pops = 1; pushes = 1; ok = slotOk(instr.operand); break;
+            case OpCode::AddTopImm: pops = 1; pushes = 1; ok = constantOk(instr.operand); break;
+            case OpCode::JumpUnlessLessImm: case OpCode::JumpUnlessGreaterImm: case OpCode::JumpUnlessEqualImm:
+                ok = slotOk(instr.a) && constantOk(instr.operand); branches = true; target = instr.b; break;
+            case OpCode::JumpUnlessLess: case OpCode::JumpUnlessGreater: case OpCode::JumpUnlessEqual:
+                ok = slotOk(instr.a) && slotOk(instr.operand); branches = true; target = instr.b; break;
+        }
+        if (!ok) return fail(pc, "operand out of range");
+        if (depth < pops) return fail(pc, "stack underflow");
+        int after = depth - pops + pushes;
+        if (after > bytecode.maxStack) return fail(pc, "stack deeper than maxStack");
+        std::vector<int> successors;
+        if (branches) {
+            if (!targetOk(target)) return fail(pc, "jump out of range");
+            successors.push_back(target);
+        }
+        if (fallsThrough) {
+            if (pc + 1 >= size) return fail(pc, "falls off the end");
+            successors.push_back(static_cast<int>(pc + 1));
+        }
+        for (int next : successors) {
+            if (depthAt[next] < 0) {
+                depthAt[next] = after;
+                worklist.push_back(next);
+            } else if (depthAt[next] != after) {
+                return fail(next, "inconsistent stack depth");
+            }
+        }
+    }
+    return true;
+}
+
+namespace {
+    void appendBytes(std::string& out, const void* data, size_t size) {
+        out.append(static_cast<const char*>(data), size);
+    }
+    
+    void alignTo8(std::string& out) {
+        out.resize((out.size() + 7) & ~static_cast<size_t>(7), '\0');
+    }
+}
+
+bool writeImage(const std::string& path, ProgramNode* program, const Bytecode& bytecode) {
+    ImageHeader header = {};
+    std::memcpy(header.magic, "SMPB", 4);
+    header.version = imageVersion;
+    header.slotCount = static_cast<uint32_t>(program->slotCount);
+    header.maxStack = static_cast<uint32_t>(bytecode.maxStack);
+    
+    std::string out(sizeof(ImageHeader), '\0');
+    header.constantCount = static_cast<uint32_t>(bytecode.constants.size());
+    header.constantOffset = static_cast<uint32_t>(out.size());
+    appendBytes(out, bytecode.constants.data(), bytecode.constants.size() * sizeof(long long));
+    
+    header.instructionCount = static_cast<uint32_t>(bytecode.code.size());
+    header.instructionOffset = static_cast<uint32_t>(out.size());
+    for (const auto& instr : bytecode.code) {
+        // Field by field, so the padding after op is always zero
+        char record[sizeof(Instruction)] = {};
+        std::memcpy(record + offsetof(Instruction, op), &instr.op, sizeof(instr.op));
+        std::memcpy(record + offsetof(Instruction, operand), &instr.operand, sizeof(instr.operand));
+        std::memcpy(record + offsetof(Instruction, a), &instr.a, sizeof(instr.a));
+        std::memcpy(record + offsetof(Instruction, b), &instr.b, sizeof(instr.b));
+        appendBytes(out, record, sizeof(record));
+    }
+    
+    header.lineCount = static_cast<uint32_t>(bytecode.lines.size());
+    header.lineOffset = static_cast<uint32_t>(out.size());
+    appendBytes(out, bytecode.lines.data(), bytecode.lines.size() * sizeof(LineEntry));
+    
+    header.nameOffset = static_cast<uint32_t>(out.size());
+    for (const auto& varDecl : program->varDecls) {
+        if (auto var = dynamic_cast<VarDeclNode*>(varDecl.get())) {
+            out += var->identifier;
+            out += '\0';
+        }
+    }
+    header.nameBytes = static_cast<uint32_t>(out.size() - header.nameOffset);
+    alignTo8(out);
+    std::memcpy(&out[0], &header, sizeof(header));
+    
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+// A read-only mapping of an image, checked once at load time
+class MappedImage {
+public:
+    MappedImage() = default;
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+    
+    ~MappedImage() {
+        if (base) munmap(base, length);
+    }
+    
+    bool open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ImageHeader))) {
+            ::close(fd);
+            error = "not a bytecode image";
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            error = "mmap failed";
+            return false;
+        }
+        base = mapping;
+        return validate(error);
+    }
+    
+    const ImageHeader& header() const {
+        return *static_cast<const ImageHeader*>(base);
+    }
+    
+    BytecodeView view() const {
+        return BytecodeView(section<Instruction>(header().instructionOffset), header().instructionCount,
+                            section<long long>(header().constantOffset), static_cast<int>(header().maxStack));
+    }
+    
+    const long long* constants() const { return section<long long>(header().constantOffset); }
+    
+    // Source line of the instruction at pc, or 0 if unknown
+    unsigned lineOf(size_t pc) const {
+        const LineEntry* lines = section<LineEntry>(header().lineOffset);
+        const LineEntry* end = lines + header().lineCount;
+        const LineEntry* it = std::upper_bound(lines, end, pc,
+            [](size_t value, const LineEntry& entry) { return value < entry.pc; });
+        return it == lines ? 0 : (it - 1)->line;
+    }
+    
+    std::vector<std::string> variableNames() const {
+        std::vector<std::string> names;
+        const char* p = section<char>(header().nameOffset);
+        const char* end = p + header().nameBytes;
+        while (p < end) {
+            names.emplace_back(p);
+            p += names.back().size() + 1;
+        }
+        return names;
+    }
+    
+private:
+    void* base = nullptr;
+    size_t length = 0;
+    
+    template <typename T>
+    const T* section(uint32_t offset) const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(base) + offset);
+    }
+    
+    bool sectionOk(uint32_t offset, uint64_t bytes) const {
+        return offset % 8 == 0 && offset >= sizeof(ImageHeader) && offset + bytes <= length;
+    }
+    
+    bool validate(std::string& error) {
+        const ImageHeader& h = header();
+        if (std::memcmp(h.magic, "SMPB", 4) != 0) {
+            error = "not a bytecode image";
+            return false;
+        }
+        if (h.version != imageVersion) {
+            error = "image version " + std::to_string(h.version) + ", expected " + std::to_string(imageVersion);
+            return false;
+        }
+        if (!sectionOk(h.constantOffset, uint64_t(h.constantCount) * sizeof(long long)) ||
+            !sectionOk(h.instructionOffset, uint64_t(h.instructionCount) * sizeof(Instruction)) ||
+            !sectionOk(h.lineOffset, uint64_t(h.lineCount) * sizeof(LineEntry)) ||
+            h.nameOffset < sizeof(ImageHeader) || uint64_t(h.nameOffset) + h.nameBytes > length ||
+            (h.nameBytes > 0 && section<char>(h.nameOffset)[h.nameBytes - 1] != '\0') ||
+            h.maxStack > (1u << 20) || h.slotCount > (1u << 24)) {
+            error = "corrupt image header";
+            return false;
+        }
+        if (!verifyBytecode(view(), h.constantCount, static_cast<int>(h.slotCount), error)) {
+            error = "invalid bytecode: " + error;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Prints an image's code with its source lines and variable names
+void disassemble(const MappedImage& image, std::ostream& out) {
+    const ImageHeader& h = image.header();
+    auto names = image.variableNames();
+    auto name = [&](int slot) {
+        return slot >= 0 && static_cast<size_t>(slot) < names.size() ? names[slot] : "$" + std::to_string(slot);
+    };
+    out << "Image v" << h.version << ": " << h.slotCount << " slots, " << h.constantCount
+        << " constants, " << h.instructionCount << " instructions, max stack " << h.maxStack << "\n";
+    BytecodeView code = image.view();
+    unsigned lastLine = 0;
+    for (size_t pc = 0; pc < code.size; ++pc) {
+        const Instruction& instr = code.code[pc];
+        unsigned line = image.lineOf(pc);
+        if (line != lastLine) {
+            out << "line " << line << ":\n";
+            lastLine = line;
+        }
+        out << "  " << std::setw(4) << pc << "  " << opCodeName(instr.op);
+        switch (instr.op) {
+            case OpCode::Const: out << " " << code.constants[instr.operand]; break;
+            case OpCode::Load: case OpCode::Store: case OpCode::Read:
+            case OpCode::AddTopSlot: case OpCode::SubTopSlot:
+                out << " " << name(instr.operand); break;
+            case OpCode::Jump: case OpCode::JumpIfFalse: out << " -> " << instr.operand; break;
+            case OpCode::AddSlotImm: case OpCode::StoreImm:
+                out << " " << name(instr.a) << ", " << code.constants[instr.operand]; break;
+            case OpCode::AddSlots: case OpCode::SubSlots:
+                out << " " << name(instr.a) << ", " << name(instr.b) << ", " << name(instr.operand); break;
+            case OpCode::Move: out << " " << name(instr.a) << ", " << name(instr.operand); break;
+            case OpCode::PrintSlot: out << " " << name(instr.a); break;
+            case OpCode::AddTopImm: out << " " << code.constants[instr.operand]; break;
+            case OpCode::JumpUnlessLessImm: case OpCode::JumpUnlessGreaterImm: case OpCode::JumpUnlessEqualImm:
+                out << " " << name(instr.a) << ", " << code.constants[instr.operand] << " -> " << instr.b; break;
+            case OpCode::JumpUnlessLess: case OpCode::JumpUnlessGreater: case OpCode::JumpUnlessEqual:
+                out << " " << name(instr.a) << ", " << name(instr.operand) << " -> " << instr.b; break;
+            default: break;
+        }
+        out << "\n";
+    }
+}
+
+// --------------------------------------------------------------------------
+// Tiered Execution
+// --------------------------------------------------------------------------
+
+// Runs every program in the AST interpreter (tier 0), counting back edges
+// per Iteration. A loop that crosses the threshold is compiled to bytecode
+// (tier 1) and resumed there: the named variables are copied into slots,
+// the loop continues from its condition, and the slots are copied back
+// when it exits. Later entries to that loop go straight to tier 1.
+class TieredExecutor : public Interpreter {
+public:
+    TieredExecutor(std::istream& in, std::ostream& out, long long threshold)
+        : Interpreter(in, out), threshold(threshold), vm(in, out) {}
+    
+    void run(ASTNode* root) {
+        auto program = dynamic_cast<ProgramNode*>(root);
+        if (!program) return;
+        auto start = Clock::now();
+        for (const auto& varDecl : program->varDecls) {
+            if (auto var = dynamic_cast<VarDeclNode*>(varDecl.get()))
+                slotNames.push_back(var->identifier);
+        }
+        slots.assign(slotNames.size() + 1, 0);
+        Interpreter::run(root);
+        totalMs = elapsedMs(start);
+    }
+    
+    void report(std::ostream& os) const {
+        os << "Tier 0 (AST):      " << totalMs - tier1Ms - compileMs << " ms\n";
+        os << "Tier 1 (bytecode): " << tier1Ms << " ms, "
+           << vm.dispatched << " instructions dispatched\n";
+        os << "Compilation:       " << compileMs << " ms\n";
+        os << "Promotions:        " << promotions << " loop(s), "
+           << tier1Entries << " tier 1 entries\n";
+    }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct LoopProfile {
+        long long backEdges = 0;
+        bool compiled = false;
+        Bytecode bytecode;
+    };
+    
+    long long threshold;
+    BytecodeVM vm;
+    std::vector<std::string> slotNames;
+    std::vector<long long> slots;
+    std::unordered_map<IterationNode*, LoopProfile> loops;
+    
+    double totalMs = 0, tier1Ms = 0, compileMs = 0;
+    int promotions = 0;
+    long long tier1Entries = 0;
+    
+    static double elapsedMs(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+    
+    // On-stack transfer: tier 0 state into slots, run the loop, and back
+    void runCompiled(LoopProfile& profile) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < slotNames.size(); ++i) slots[i] = variables[slotNames[i]];
+        vm.run(profile.bytecode, slots.data());
+        for (size_t i = 0; i < slotNames.size(); ++i) variables[slotNames[i]] = slots[i];
+        tier1Entries++;
+        tier1Ms += elapsedMs(start);
+    }
+    
+    void promote(IterationNode* loop, LoopProfile& profile) {
+        auto start = Clock::now();
+        profile.bytecode = BytecodeCompiler().compile(loop);
+        profile.compiled = true;
+        promotions++;
+        compileMs += elapsedMs(start);
+    }
+    
+    void executeLoop(IterationNode* loop) override {
+        LoopProfile& profile = loops[loop];
+        if (profile.compiled) {
+            runCompiled(profile);
+            return;
+        }
+        while (evaluate(loop->condition.get())) {
+            execute(loop->body.get());
+            if (++profile.backEdges >= threshold) {
+                // A nested loop may have been promoted meanwhile; the
+                // outer one is compiled whole either way
+                promote(loop, profile);
+                runCompiled(profile);
+                return;
+            }
+        }
+    }
+};
+
+// --------------------------------------------------------------------------
+// Green Threads
+// --------------------------------------------------------------------------
+
+// One run of a program on the Scheduler. Runs of the same program share
+// its bytecode; everything that changes lives here.
+struct GreenThread {
+    enum class State { Queued, Running, Blocked, Done };
+    using Clock = std::chrono::steady_clock;
+    
+    int id = 0;
+    BytecodeView bytecode;
+    std::vector<long long> slots;
+    std::vector<long long> stack;
+    VMRegisters regs;
+    
+    std::mutex inputLock;  // guards input, inputClosed and state
+    std::deque<long long> input;
+    bool inputClosed = false;
+    State state = State::Queued;
+    
+    std::string output;
+    long long dispatched = 0;
+    int slices = 0;
+    Clock::time_point spawned, finished;
+    
+    GreenThread(int id, const BytecodeView& bytecode, int slotCount)
+        : id(id), bytecode(bytecode), slots(slotCount + 1, 0), stack(bytecode.maxStack + 1, 0) {}
+};
+
+// Runs many programs as green threads on a few OS threads. A thread is
+// preempted after `budget` instructions (checked at loop back edges) and
+// goes to the back of its worker's queue; a Read with no input parks it
+// until feed() or closeInput() supplies some. Each worker has its own
+// FIFO run queue, and an idle worker steals half of another's queue.
+class Scheduler {
+public:
+    struct Options {
+        int workers = 4;
+        long long budget = 10000;
+        bool stealing = true;
+    };
+    
+    std::atomic<long long> preemptions{0}, parks{0}, steals{0};
+    
+    explicit Scheduler(Options options) : options(options) {
+        for (int w = 0; w < options.workers; ++w) workers.push_back(std::make_unique<Worker>());
+        for (int w = 0; w < options.workers; ++w)
+            workers[w]->thread = std::thread([this, w] { workerLoop(w); });
+    }
+    
+    ~Scheduler() {
+        {
+            std::lock_guard<std::mutex> guard(idleLock);
+            stopping = true;
+        }
+        idleSignal.notify_all();
+        for (auto& worker : workers) worker->thread.join();
+    }
+    
+    int spawn(const BytecodeView& bytecode, int slotCount) {
+        GreenThread* thread;
+        {
+            std::lock_guard<std::mutex> guard(threadsLock);
+            threads.push_back(std::make_unique<GreenThread>(static_cast<int>(threads.size()), bytecode, slotCount));
+            thread = threads.back().get();
+        }
+        thread->spawned = GreenThread::Clock::now();
+        live++;
+        enqueue(thread, nextWorker++ % workers.size());
+        return thread->id;
+    }
+    
+    void feed(int id, long long value) {
+        GreenThread* thread = lookup(id);
+        std::unique_lock<std::mutex> guard(thread->inputLock);
+        thread->input.push_back(value);
+        wake(thread, guard);
+    }
+    
+    // Reads after the input runs out yield 0, as with an exhausted stream
+    void closeInput(int id) {
+        GreenThread* thread = lookup(id);
+        std::unique_lock<std::mutex> guard(thread->inputLock);
+        thread->inputClosed = true;
+        wake(thread, guard);
+    }
+    
+    // Blocks until every spawned thread has halted
+    void wait() {
+        std::unique_lock<std::mutex> guard(doneLock);
+        doneSignal.wait(guard, [this] { return live == 0; });
+    }
+    
+    const GreenThread& thread(int id) {
+        return *lookup(id);
+    }
+    
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<GreenThread*> queue;
+        std::atomic<int> queued{0};
+        std::thread thread;
+    };
+    
+    struct GreenIO {
+        GreenThread& thread;
+        
+        bool read(long long& value) {
+            std::lock_guard<std::mutex> guard(thread.inputLock);
+            if (!thread.input.empty()) {
+                value = thread.input.front();
+                thread.input.pop_front();
+                return true;
+            }
+            if (!thread.inputClosed) return false;
+            value = 0;
+            return true;
+        }
+        
+        void print(long long value) {
+            thread.output += std::to_string(value);
+            thread.output += '\n';
+        }
+    };
+    
+    Options options;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex threadsLock;
+    std::deque<std::unique_ptr<GreenThread>> threads;
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<long long> pending{0};  // threads sitting in some queue
+    std::atomic<long long> live{0};     // spawned and not yet halted
+    std::atomic<int> idle{0};
+    std::mutex idleLock;
+    std::condition_variable idleSignal;
+    bool stopping = false;
+    std::mutex doneLock;
+    std::condition_variable doneSignal;
+    
+    GreenThread* lookup(int id) {
+        std::lock_guard<std::mutex> guard(threadsLock);
+        return threads.at(id).get();
+    }
+    
+    // Called with the thread's input lock held
+    void wake(GreenThread* thread, std::unique_lock<std::mutex>& guard) {
+        if (thread->state != GreenThread::State::Blocked) return;
+        thread->state = GreenThread::State::Queued;
+        guard.unlock();
+        enqueue(thread, nextWorker++ % workers.size());
+    }
+    
+    void enqueue(GreenThread* thread, size_t w) {
+        {
+            std::lock_guard<std::mutex> guard(workers[w]->lock);
+            workers[w]->queue.push_back(thread);
+        }
+        workers[w]->queued++;
+        pending++;
+        if (idle > 0) {
+            // Taking the lock orders this with a worker that is about to sleep
+            { std::lock_guard<std::mutex> guard(idleLock); }
+            idleSignal.notify_all();
+        }
+    }
+    
+    GreenThread* take(size_t w) {
+        Worker& own = *workers[w];
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.queue.empty()) {
+                GreenThread* thread = own.queue.front();
+                own.queue.pop_front();
+                own.queued--;
+                pending--;
+                return thread;
+            }
+        }
+        if (!options.stealing) return nullptr;
+        for (size_t i = 1; i < workers.size(); ++i) {
+            Worker& victim = *workers[(w + i) % workers.size()];
+            if (victim.queued == 0) continue;
+            std::vector<GreenThread*> loot;
+            {
+                std::lock_guard<std::mutex> guard(victim.lock);
+                size_t half = (victim.queue.size() + 1) / 2;
+                for (size_t k = 0; k < half; ++k) {
+                    loot.push_back(victim.queue.back());
+                    victim.queue.pop_back();
+                }
+                victim.queued -= static_cast<int>(half);
+            }
+            if (loot.empty()) continue;
+            steals++;
+            GreenThread* thread = loot.back();
+            loot.pop_back();
+            pending--;
+            if (!loot.empty()) {
+                std::lock_guard<std::mutex> guard(own.lock);
+                // Keep the victim's order: oldest first
+                for (auto it = loot.rbegin(); it != loot.rend(); ++it) own.queue.push_back(*it);
+                own.queued += static_cast<int>(loot.size());
+            }
+            return thread;
+        }
+        return nullptr;
+    }
+    
+    void workerLoop(size_t w) {
+        for (;;) {
+            GreenThread* thread = take(w);
+            if (thread) {
+                runSlice(thread, w);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(idleLock);
+            idle++;
+            idleSignal.wait(guard, [&] {
+                return stopping || (options.stealing ? pending > 0 : workers[w]->queued > 0);
+            });
+            idle--;
+            if (stopping) return;
+        }
+    }
+    
+    void setState(GreenThread* thread, GreenThread::State state) {
+        std::lock_guard<std::mutex> guard(thread->inputLock);
+        thread->state = state;
+    }
+    
+    void runSlice(GreenThread* thread, size_t w) {
+        setState(thread, GreenThread::State::Running);
+        thread->slices++;
+        GreenIO io{*thread};
+        VMStatus status = executeBytecode<false>(thread->bytecode, thread->slots.data(), thread->stack.data(),
+                                                 thread->regs, io, options.budget, thread->dispatched);
+        if (status == VMStatus::OutOfBudget) {
+            preemptions++;
+            setState(thread, GreenThread::State::Queued);
+            enqueue(thread, w);
+        } else if (status == VMStatus::WaitingForInput) {
+            std::unique_lock<std::mutex> guard(thread->inputLock);
+            // Input may have arrived since the Read looked
+            if (!thread->input.empty() || thread->inputClosed) {
+                thread->state = GreenThread::State::Queued;
+                guard.unlock();
+                enqueue(thread, w);
+            } else {
+                thread->state = GreenThread::State::Blocked;
+                parks++;
+            }
+        } else {
+            thread->finished = GreenThread::Clock::now();
+            setState(thread, GreenThread::State::Done);
+            if (--live == 0) {
+                { std::lock_guard<std::mutex> guard(doneLock); }
+                doneSignal.notify_all();
+            }
+        }
+    }
+};
+
+// --------------------------------------------------------------------------
+// SPMD Batch Execution
+// --------------------------------------------------------------------------
+
+// Lane kernels over int64 vectors. Comparisons and masks use -1 for true
+// and 0 for false so that they can drive blends directly. Every length is
+// a multiple of the batch width, so the SIMD versions need no tail loop.
+struct LaneKernels {
+    const char* name;
+    void (*add)(long long* out, const long long* a, const long long* b, int n);
+    void (*sub)(long long* out, const long long* a, const long long* b, int n);
+    void (*less)(long long* out, const long long* a, const long long* b, int n);
+    void (*greater)(long long* out, const long long* a, const long long* b, int n);
+    void (*equal)(long long* out, const long long* a, const long long* b, int n);
+    void (*maskAnd)(long long* out, const long long* a, const long long* b, int n);
+    void (*select)(long long* dst, const long long* src, const long long* mask, int n);
+    bool (*any)(const long long* mask, int n);
+};
+
+namespace scalar_kernels {
+    void add(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = wrapAdd(a[i], b[i]);
+    }
+    void sub(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = wrapSub(a[i], b[i]);
+    }
+    void less(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = -static_cast<long long>(a[i] < b[i]);
+    }
+    void greater(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = -static_cast<long long>(a[i] > b[i]);
+    }
+    void equal(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = -static_cast<long long>(a[i] == b[i]);
+    }
+    void maskAnd(long long* out, const long long* a, const long long* b, int n) {
+        for (int i = 0; i < n; ++i) out[i] = a[i] & b[i];
+    }
+    void select(long long* dst, const long long* src, const long long* mask, int n) {
+        for (int i = 0; i < n; ++i) dst[i] = (src[i] & mask[i]) | (dst[i] & ~mask[i]);
+    }
+    bool any(const long long* mask, int n) {
+        for (int i = 0; i < n; ++i) if (mask[i]) return true;
+        return false;
+    }
+}
+
+#ifdef SIMPLE_X86_KERNELS
+// pcmpgtq needs SSE4.2; everything else here is SSE2/SSE4.1
+namespace sse_kernels {
+    #define SSE_BINARY(NAME, EXPR) \
+        __attribute__((target("sse4.2"))) \
+        void NAME(long long* out, const long long* a, const long long* b, int n) { \
+            for (int i = 0; i < n; i += 2) { \
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)); \
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)); \
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), EXPR); \
+            } \
+        }
+    SSE_BINARY(add, _mm_add_epi64(x, y))
+    SSE_BINARY(sub, _mm_sub_epi64(x, y))
+    SSE_BINARY(less, _mm_cmpgt_epi64(y, x))
+    SSE_BINARY(greater, _mm_cmpgt_epi64(x, y))
+    SSE_BINARY(equal, _mm_cmpeq_epi64(x, y))
+    SSE_BINARY(maskAnd, _mm_and_si128(x, y))
+    #undef SSE_BINARY
+    
+    __attribute__((target("sse4.2")))
+    void select(long long* dst, const long long* src, const long long* mask, int n) {
+        for (int i = 0; i < n; i += 2) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_blendv_epi8(d, s, m));
+        }
+    }
+    
+    __attribute__((target("sse4.2")))
+    bool any(const long long* mask, int n) {
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < n; i += 2)
+            acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i)));
+        return !_mm_testz_si128(acc, acc);
+    }
+}
+
+namespace avx2_kernels {
+    #define AVX2_BINARY(NAME, EXPR) \
+        __attribute__((target("avx2"))) \
+        void NAME(long long* out, const long long* a, const long long* b, int n) { \
+            for (int i = 0; i < n; i += 4) { \
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)); \
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)); \
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), EXPR); \
+            } \
+        }
+    AVX2_BINARY(add, _mm256_add_epi64(x, y))
+    AVX2_BINARY(sub, _mm256_sub_epi64(x, y))
+    AVX2_BINARY(less, _mm256_cmpgt_epi64(y, x))
+    AVX2_BINARY(greater, _mm256_cmpgt_epi64(x, y))
+    AVX2_BINARY(equal, _mm256_cmpeq_epi64(x, y))
+    AVX2_BINARY(maskAnd, _mm256_and_si256(x, y))
+    #undef AVX2_BINARY
+    
+    __attribute__((target("avx2")))
+    void select(long long* dst, const long long* src, const long long* mask, int n) {
+        for (int i = 0; i < n; i += 4) {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(d, s, m));
+        }
+    }
+    
+    __attribute__((target("avx2")))
+    bool any(const long long* mask, int n) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int i = 0; i < n; i += 4)
+            acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i)));
+        return !_mm256_testz_si256(acc, acc);
+    }
+}
+#endif
+
+const LaneKernels scalarKernels = {
+    "scalar", scalar_kernels::add, scalar_kernels::sub, scalar_kernels::less,
+    scalar_kernels::greater, scalar_kernels::equal, scalar_kernels::maskAnd,
+    scalar_kernels::select, scalar_kernels::any
+};
+
+#ifdef SIMPLE_X86_KERNELS
+const LaneKernels sseKernels = {
+    "sse4.2", sse_kernels::add, sse_kernels::sub, sse_kernels::less,
+    sse_kernels::greater, sse_kernels::equal, sse_kernels::maskAnd,
+    sse_kernels::select, sse_kernels::any
+};
+
+const LaneKernels avx2Kernels = {
+    "avx2", avx2_kernels::add, avx2_kernels::sub, avx2_kernels::less,
+    avx2_kernels::greater, avx2_kernels::equal, avx2_kernels::maskAnd,
+    avx2_kernels::select, avx2_kernels::any
+};
+#endif
+
+// The kernel sets this CPU can run, best first
+std::vector<const LaneKernels*> availableKernels() {
+    std::vector<const LaneKernels*> kernels;
+#ifdef SIMPLE_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(&avx2Kernels);
+    if (__builtin_cpu_supports("sse4.2")) kernels.push_back(&sseKernels);
+#endif
+    kernels.push_back(&scalarKernels);
+    return kernels;
+}
+
+// Runs one program over many input sets at once. Each input set is a lane;
+// each variable slot holds one int64 per lane. If and Iteration narrow an
+// execution mask instead of branching, and a loop keeps going while any
+// lane is still inside it. Input sets are processed `width` lanes at a time.
+class BatchExecutor {
+public:
+    static constexpr int width = 256;
+    
+    BatchExecutor(ProgramNode* program, const LaneKernels& kernels)
+        : program(program), k(kernels) {}
+    
+    // inputs[i] is the whitespace-separated input of set i; returns what
+    // each set printed, formatted as the scalar interpreters print it
+    std::vector<std::string> run(const std::vector<std::string>& inputs) {
+        std::vector<std::string> outputs(inputs.size());
+        slots.assign(static_cast<size_t>(program->slotCount) * width, 0);
+        for (size_t first = 0; first < inputs.size(); first += width) {
+            size_t count = std::min<size_t>(width, inputs.size() - first);
+            loadInputs(inputs, first, count);
+            std::fill(slots.begin(), slots.end(), 0);
+            std::vector<long long>& mask = maskAt(0);
+            for (int lane = 0; lane < width; ++lane) mask[lane] = lane < static_cast<int>(count) ? -1 : 0;
+            execute(program->block.get(), 0);
+            for (size_t lane = 0; lane < count; ++lane) outputs[first + lane] = std::move(laneOutput[lane]);
+        }
+        return outputs;
+    }
+    
+private:
+    ProgramNode* program;
+    const LaneKernels& k;
+    std::vector<long long> slots;  // slot-major: slots[slot * width + lane]
+    // Deques, so that growing them never moves a vector still in use
+    std::deque<std::vector<long long>> temps;
+    std::deque<std::vector<long long>> masks;
+    std::vector<std::vector<long long>> laneInput;
+    std::vector<size_t> inputPos;
+    std::vector<std::string> laneOutput;
+    
+    long long* slot(int index) {
+        return slots.data() + static_cast<size_t>(index) * width;
+    }
+    
+    std::vector<long long>& tempAt(size_t depth) {
+        while (temps.size() <= depth) temps.emplace_back(width);
+        return temps[depth];
+    }
+    
+    std::vector<long long>& maskAt(size_t depth) {
+        while (masks.size() <= depth) masks.emplace_back(width);
+        return masks[depth];
+    }
+    
+    std::unordered_map<ASTNode*, std::vector<long long>> constants;
+    
+    // Parsed up front with the same rules as std::cin >> value: reading
+    // stops at the first malformed token, an out-of-range value is clamped
+    // and ends the input, and every read after that yields 0
+    static void parseInput(const std::string& text, std::vector<long long>& values) {
+        size_t i = 0, n = text.size();
+        for (;;) {
+            while (i < n && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+            bool negative = false;
+            if (i < n && (text[i] == '-' || text[i] == '+')) negative = text[i++] == '-';
+            if (i == n || !std::isdigit(static_cast<unsigned char>(text[i]))) return;
+            unsigned long long magnitude = 0;
+            bool overflow = false;
+            const unsigned long long limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+            while (i < n && std::isdigit(static_cast<unsigned char>(text[i]))) {
+                unsigned digit = text[i++] - '0';
+                if (magnitude > (limit - digit) / 10) overflow = true;
+                else magnitude = magnitude * 10 + digit;
+            }
+            if (overflow) {
+                values.push_back(negative ? -9223372036854775807LL - 1 : 9223372036854775807LL);
+                return;
+            }
+            values.push_back(negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude));
+        }
+    }
+    
+    void loadInputs(const std::vector<std::string>& inputs, size_t first, size_t count) {
+        laneInput.assign(width, {});
+        inputPos.assign(width, 0);
+        laneOutput.assign(width, {});
+        for (size_t lane = 0; lane < count; ++lane) parseInput(inputs[first + lane], laneInput[lane]);
+    }
+    
+    void execute(ASTNode* node, size_t depth) {
+        const long long* mask = masks[depth].data();
+        if (auto block = dynamic_cast<BlockNode*>(node)) {
+            for (const auto& stmt : block->statements) execute(stmt.get(), depth);
+        } else if (auto assign = dynamic_cast<AssignNode*>(node)) {
+            const long long* value = evaluate(assign->expr.get(), 0);
+            k.select(slot(assign->slot), value, mask, width);
+        } else if (auto print = dynamic_cast<PrintNode*>(node)) {
+            const long long* value = evaluate(print->expr.get(), 0);
+            for (int lane = 0; lane < width; ++lane) {
+                if (mask[lane]) {
+                    laneOutput[lane] += std::to_string(value[lane]);
+                    laneOutput[lane] += '\n';
+                }
+            }
+        } else if (auto read = dynamic_cast<ReadNode*>(node)) {
+            long long* target = slot(read->slot);
+            for (int lane = 0; lane < width; ++lane) {
+                if (!mask[lane]) continue;
+                const auto& input = laneInput[lane];
+                target[lane] = inputPos[lane] < input.size() ? input[inputPos[lane]++] : 0;
+            }
+        } else if (auto ifNode = dynamic_cast<IfNode*>(node)) {
+            std::vector<long long>& inner = maskAt(depth + 1);
+            k.maskAnd(inner.data(), masks[depth].data(), evaluate(ifNode->condition.get(), 0), width);
+            if (k.any(inner.data(), width)) execute(ifNode->body.get(), depth + 1);
+        } else if (auto loop = dynamic_cast<IterationNode*>(node)) {
+            std::vector<long long>& inner = maskAt(depth + 1);
+            std::copy(masks[depth].begin(), masks[depth].end(), inner.begin());
+            for (;;) {
+                // Lanes that fail the condition have left the loop for good
+                k.maskAnd(inner.data(), inner.data(), evaluate(loop->condition.get(), 0), width);
+                if (!k.any(inner.data(), width)) break;
+                execute(loop->body.get(), depth + 1);
+            }
+        }
+    }
+    
+    // Results of depth d live in temps[d]; operands of a binary expression
+    // use d and d + 1, so nothing is overwritten while still needed
+    const long long* evaluate(ASTNode* node, size_t depth) {
+        if (auto literal = dynamic_cast<IntLiteralNode*>(node)) {
+            // Broadcast once per literal
+            std::vector<long long>& out = constants[node];
+            if (out.empty()) out.assign(width, literal->number);
+            return out.data();
+        }
+        if (auto id = dynamic_cast<IdentifierNode*>(node)) {
+            return slot(id->slot);
+        }
+        if (auto binExpr = dynamic_cast<BinaryExprNode*>(node)) {
+            const long long* left = evaluate(binExpr->left.get(), depth);
+            const long long* right = evaluate(binExpr->right.get(), depth + 1);
+            long long* out = tempAt(depth).data();
+            if (binExpr->op == "+") k.add(out, left, right, width);
+            else if (binExpr->op == "-") k.sub(out, left, right, width);
+            else if (binExpr->op == "<") k.less(out, left, right, width);
+            else if (binExpr->op == ">") k.greater(out, left, right, width);
+            else k.equal(out, left, right, width);
+            return out;
+        }
+        return tempAt(depth).data();
+    }
+};
+
+// --------------------------------------------------------------------------
+// Benchmark: AST interpreter against the C back end
+// --------------------------------------------------------------------------
+
+// One shell word, whatever the path contains: 'it'\''s' for it's
+std::string shellQuote(const std::string& word) {
+    std::string quoted = "'";
+    for (char c : word) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+
+std::string runCommand(const std::string& command) {
+    std::string output;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return output;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) output.append(buffer, n);
+    pclose(pipe);
+    return output;
+}
+
+void benchmark(ASTNode* ast) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    
+    std::istringstream noInput;
+    std::ostringstream interpreted;
+    auto t0 = Clock::now();
+    Interpreter(noInput, interpreted).run(ast);
+    auto t1 = Clock::now();
+    
+    std::ostringstream tieredOutput;
+    TieredExecutor tiered(noInput, tieredOutput, 1000);
+    auto tieredStart = Clock::now();
+    tiered.run(ast);
+    auto tieredEnd = Clock::now();
+    
+    std::string base = "/tmp/simple_c_" + std::to_string(Clock::now().time_since_epoch().count());
+    {
+        std::ofstream cFile(base + ".c");
+        CCodeGenerator().generate(ast, cFile);
+    }
+    auto t2 = Clock::now();
+    if (std::system(("cc -O2 -o " + shellQuote(base) + " " + shellQuote(base + ".c")).c_str()) != 0) {
+        std::cerr << "Error: C compiler failed\n";
+        return;
+    }
+    auto t3 = Clock::now();
+    std::string native = runCommand(shellQuote(base) + " < /dev/null");
+    auto t4 = Clock::now();
+    std::remove(base.c_str());
+    std::remove((base + ".c").c_str());
+    
+    std::cout << "AST interpreter: " << ms(t0, t1) << " ms\n";
+    std::cout << "Tiered:          " << ms(tieredStart, tieredEnd) << " ms\n";
+    std::cout << "Generated C:     " << ms(t3, t4) << " ms (cc -O2 took " << ms(t2, t3) << " ms)\n";
+    std::cout << "Speedup:         " << ms(t0, t1) / ms(tieredStart, tieredEnd) << "x tiered, "
+              << ms(t0, t1) / ms(t3, t4) << "x C\n";
+    std::cout << "Output " << (native == interpreted.str() && tieredOutput.str() == native ? "matches" : "DIFFERS") << "\n";
+    std::cout << "\n=== Tiered Execution ===\n";
+    tiered.report(std::cout);
+}
+
+// Runs the program with the same input through the AST interpreter, the
+// bytecode VM and the generated C; true if all three print the same
+bool checkBackends(ASTNode* ast, const std::string& inputPath) {
+    std::ifstream file(inputPath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: cannot open " << inputPath << "\n";
+        return false;
+    }
+    std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    
+    std::istringstream interpreterIn(input);
+    std::ostringstream interpreted;
+    Interpreter(interpreterIn, interpreted).run(ast);
+    
+    auto program = dynamic_cast<ProgramNode*>(ast);
+    SuperinstructionPass pass;
+    Bytecode bytecode = compileFused(program, pass);
+    std::vector<long long> slots(program->slotCount + 1, 0);
+    std::istringstream vmIn(input);
+    std::ostringstream vmOutput;
+    BytecodeVM(vmIn, vmOutput).run(bytecode, slots.data());
+    
+    std::string base = "/tmp/simple_check_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream cFile(base + ".c");
+        CCodeGenerator().generate(ast, cFile);
+    }
+    if (std::system(("cc -O2 -o " + shellQuote(base) + " " + shellQuote(base + ".c")).c_str()) != 0) {
+        std::cerr << "Error: C compiler failed\n";
+        std::remove((base + ".c").c_str());
+        return false;
+    }
+    std::string native = runCommand(shellQuote(base) + " < " + shellQuote(inputPath));
+    std::remove(base.c_str());
+    std::remove((base + ".c").c_str());
+    
+    bool same = vmOutput.str() == interpreted.str() && native == interpreted.str();
+    if (!same) {
+        std::cout << "Interpreter:\n" << interpreted.str() << "Bytecode:\n" << vmOutput.str()
+                  << "Generated C:\n" << native;
+    }
+    std::cout << "Output " << (same ? "matches" : "DIFFERS") << "\n";
+    return same;
+}
+
+// Input sets per second: the bytecode VM once per set against the batch
+// executor with each kernel set this CPU supports
+void benchmarkBatch(ASTNode* ast, size_t sets) {
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double>(b - a).count();
+    };
+    auto program = dynamic_cast<ProgramNode*>(ast);
+    if (!program) return;
+    
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(0, 99);
+    std::vector<std::string> inputs(sets);
+    for (auto& input : inputs) {
+        for (int i = 0; i < 4; ++i) input += std::to_string(value(rng)) + " ";
+    }
+    
+    Bytecode bytecode = BytecodeCompiler().compile(program->block.get());
+    std::vector<std::string> expected(sets);
+    std::vector<long long> slots(program->slotCount + 1);
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < sets; ++i) {
+        std::istringstream in(inputs[i]);
+        std::ostringstream out;
+        std::fill(slots.begin(), slots.end(), 0);
+        BytecodeVM(in, out).run(bytecode, slots.data());
+        expected[i] = out.str();
+    }
+    double scalarSeconds = seconds(t0, Clock::now());
+    std::cout << "Scalar bytecode: " << sets / scalarSeconds << " sets/s\n";
+    
+    for (const LaneKernels* kernels : availableKernels()) {
+        auto t1 = Clock::now();
+        auto outputs = BatchExecutor(program, *kernels).run(inputs);
+        double batchSeconds = seconds(t1, Clock::now());
+        std::cout << "Batch (" << kernels->name << "): " << sets / batchSeconds << " sets/s, "
+                  << scalarSeconds / batchSeconds << "x, output "
+                  << (outputs == expected ? "matches" : "DIFFERS") << "\n";
+    }
+}
+
+// Dispatch counts and runtime of the plain bytecode against the fused one
+void benchmarkBytecode(ASTNode* ast) {
+    using Clock = std::chrono::steady_clock;
+    auto program = dynamic_cast<ProgramNode*>(ast);
+    if (!program) return;
+    
+    Bytecode plain = BytecodeCompiler().compile(program->block.get());
+    SuperinstructionPass pass;
+    Bytecode fused = compileFused(program, pass);
+    
+    auto measure = [&](const Bytecode& bytecode, long long& dispatched, std::string& output) {
+        std::istringstream noInput;
+        std::ostringstream out;
+        std::vector<long long> slots(program->slotCount + 1, 0);
+        BytecodeVM vm(noInput, out);
+        auto start = Clock::now();
+        vm.run(bytecode, slots.data());
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        dispatched = vm.dispatched;
+        output = out.str();
+        return ms;
+    };
+    long long plainDispatched, fusedDispatched;
+    std::string plainOutput, fusedOutput;
+    double plainMs = measure(plain, plainDispatched, plainOutput);
+    double fusedMs = measure(fused, fusedDispatched, fusedOutput);
+    
+    std::cout << "Rule                     Sites  Profiled dispatches saved\n";
+    for (const auto& rule : pass.report) {
+        std::string name = rule.name;
+        name.resize(24, ' ');
+        std::cout << name << " " << std::setw(5) << rule.sites << "  " << rule.saved
+                  << (rule.enabled ? "" : " (off)") << "\n";
+    }
+    std::cout << "\nInstructions: " << plain.code.size() << " -> " << fused.code.size() << "\n";
+    std::cout << "Dispatches:   " << plainDispatched << " -> " << fusedDispatched << " ("
+              << 100.0 * (plainDispatched - fusedDispatched) / std::max(1LL, plainDispatched) << "% fewer)\n";
+    std::cout << "Runtime:      " << plainMs << " ms -> " << fusedMs << " ms ("
+              << 100.0 * (plainMs - fusedMs) / plainMs << "% less)\n";
+    std::cout << "Output " << (plainOutput == fusedOutput ? "matches" : "DIFFERS") << "\n";
+}
+
+// Cold start: lexing, parsing, checking and compiling a program against
+// mapping and verifying its prebuilt image, in process and as whole runs
+bool benchmarkImage(const std::string& self, const std::string& sourcePath) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    const int rounds = 20;
+    std::string imagePath = "/tmp/simple_image_" + std::to_string(Clock::now().time_since_epoch().count()) + ".sbc";
+    
+    double sourceMs = 0, imageMs = 0;
+    size_t instructions = 0;
+    for (int round = 0; round < rounds; ++round) {
+        auto t0 = Clock::now();
+        Lexer lexer(sourcePath);
+        auto tokens = lexer.tokenize();
+        Parser parser(tokens);
+        auto ast = parser.parse();
+        if (!ast || parser.errorCount > 0) return false;
+        SemanticAnalyzer analyzer(ast.get());
+        analyzer.analyze();
+        if (analyzer.errorCount > 0) return false;
+        auto program = dynamic_cast<ProgramNode*>(ast.get());
+        SuperinstructionPass pass;
+        Bytecode bytecode = compileFused(program, pass);
+        auto t1 = Clock::now();
+        sourceMs += ms(t0, t1);
+        if (round == 0 && !writeImage(imagePath, program, bytecode)) {
+            std::cerr << "Error: cannot write " << imagePath << "\n";
+            return false;
+        }
+        
+        auto t2 = Clock::now();
+        MappedImage image;
+        std::string error;
+        if (!image.open(imagePath, error)) {
+            std::cerr << "Image Error: " << error << "\n";
+            std::remove(imagePath.c_str());
+            return false;
+        }
+        instructions = image.view().size;
+        auto t3 = Clock::now();
+        imageMs += ms(t2, t3);
+    }
+    std::cout << "In process (" << instructions << " instructions, mean of " << rounds << "):\n";
+    std::cout << "  compile from source: " << sourceMs / rounds << " ms\n";
+    std::cout << "  map and verify:      " << imageMs / rounds << " ms\n";
+    
+    auto runAll = [&](const std::string& command) {
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            if (std::system((command + " < /dev/null > /dev/null").c_str()) != 0) return -1.0;
+        }
+        return ms(start, Clock::now()) / rounds;
+    };
+    double fromSource = runAll(shellQuote(self) + " " + shellQuote(sourcePath) + " --bytecode");
+    double fromImage = runAll(shellQuote(self) + " --run-image " + shellQuote(imagePath));
+    std::remove(imagePath.c_str());
+    std::cout << "Whole process (mean of " << rounds << "):\n";
+    std::cout << "  from source: " << fromSource << " ms\n";
+    std::cout << "  from image:  " << fromImage << " ms\n";
+    return true;
+}
+
+// Many concurrent programs: mostly light ones that Read two numbers (half
+// of them get their input only after everything is spawned) and one heavy
+// loop in 500. Reports throughput, completion-latency percentiles of the
+// light programs and the mean for the heavy ones, for each combination of
+// preemption and work stealing.
+void benchmarkScheduler(const std::string& lightPath, const std::string& heavyPath, int programs, int workers) {
+    using Clock = std::chrono::steady_clock;
+    Bytecode light, heavy;
+    int lightSlots, heavySlots;
+    if (!compileFile(lightPath, light, lightSlots) || !compileFile(heavyPath, heavy, heavySlots)) return;
+    
+    struct Config {
+        const char* name;
+        long long budget;
+        bool stealing;
+    };
+    const Config configs[] = {
+        {"preempt+steal", 10000, true},
+        {"steal only", LLONG_MAX, true},
+        {"preempt only", 10000, false},
+        {"neither", LLONG_MAX, false},
+    };
+    std::cout << programs << " programs on " << workers << " workers\n";
+    std::cout << "               programs/s  light latency (ms)                  heavy ms\n";
+    std::cout << "Config                       p50      p99    p99.9      max      mean  preempts  parks  steals\n";
+    for (const Config& config : configs) {
+        Scheduler scheduler({workers, config.budget, config.stealing});
+        auto start = Clock::now();
+        std::vector<int> late;
+        for (int i = 0; i < programs; ++i) {
+            bool isHeavy = i % 500 == 0;
+            int id = isHeavy ? scheduler.spawn(heavy, heavySlots) : scheduler.spawn(light, lightSlots);
+            if (isHeavy) {
+                scheduler.closeInput(id);
+                continue;
+            }
+            if (i % 2 == 0) {
+                scheduler.feed(id, id);
+                scheduler.feed(id, 1);
+                scheduler.closeInput(id);
+            } else {
+                late.push_back(id);
+            }
+        }
+        for (int id : late) {
+            scheduler.feed(id, id);
+            scheduler.feed(id, 1);
+            scheduler.closeInput(id);
+        }
+        scheduler.wait();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        
+        std::vector<double> latencies;
+        double heavyMs = 0;
+        int heavyCount = 0, wrong = 0;
+        for (int id = 0; id < programs; ++id) {
+            const GreenThread& thread = scheduler.thread(id);
+            double ms = std::chrono::duration<double, std::milli>(thread.finished - thread.spawned).count();
+            if (id % 500 == 0) {
+                heavyMs += ms;
+                heavyCount++;
+                continue;
+            }
+            latencies.push_back(ms);
+            if (thread.output != std::to_string(id + 1) + "\n") wrong++;
+        }
+        if (latencies.empty()) latencies.push_back(0);
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double q) {
+            return latencies[std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()))];
+        };
+        std::cout << std::left << std::setw(14) << config.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(11) << programs / seconds << std::setprecision(2)
+                  << std::setw(9) << percentile(0.5) << std::setw(9) << percentile(0.99)
+                  << std::setw(9) << percentile(0.999) << std::setw(9) << latencies.back()
+                  << std::setw(10) << heavyMs / std::max(1, heavyCount) << std::setw(10) << scheduler.preemptions << std::setw(7) << scheduler.parks
+                  << std::setw(8) << scheduler.steals << (wrong ? "  WRONG OUTPUT" : "") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+}
+
+// --------------------------------------------------------------------------
+// Main Function
+// --------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <source_file> [--run | --bytecode | --tiered [threshold] | --batch <inputs>"
+                  << " | --emit-c <out.c> | --emit-image <out.sbc> | --bench | --bench-batch [sets]"
+                  << " | --bench-bytecode | --bench-image]\n"
+                  << "       " << argv[0] << " --run-image <image.sbc> | --disasm <image.sbc>\n"
+                  << "       " << argv[0] << " --bench-scheduler <light> <heavy> [programs] [workers]\n";
+        return 1;
+    }
+    
+    std::string first = argv[1];
+    if (first == "--bench-scheduler" && argc > 3) {
+        benchmarkScheduler(argv[2], argv[3], argc > 4 ? std::atoi(argv[4]) : 10000,
+                           argc > 5 ? std::atoi(argv[5]) : 4);
+        return 0;
+    }
+    
+    // Images run without going anywhere near the front end
+    if ((first == "--run-image" || first == "--disasm") && argc > 2) {
+        MappedImage image;
+        std::string error;
+        if (!image.open(argv[2], error)) {
+            std::cerr << "Image Error: " << error << "\n";
+            return 1;
+        }
+        if (first == "--disasm") {
+            disassemble(image, std::cout);
+        } else {
+            std::vector<long long> slots(image.header().slotCount + 1, 0);
+            BytecodeVM(std::cin, std::cout).run(image.view(), slots.data());
+        }
+        return 0;
+    }
+    std::string mode = argc > 2 ? argv[2] : "";
+    
+    Lexer lexer(argv[1]);
+    auto tokens = lexer.tokenize();
+    
+    if (!mode.empty()) {
+        Parser parser(tokens);
+        auto ast = parser.parse();
+        if (!ast || parser.errorCount > 0) return 1;
+        SemanticAnalyzer analyzer(ast.get());
+        analyzer.analyze();
+        if (analyzer.errorCount > 0) return 1;
+        
+        if (mode == "--run") {
+            Interpreter(std::cin, std::cout).run(ast.get());
+        } else if (mode == "--bytecode") {
+            auto program = dynamic_cast<ProgramNode*>(ast.get());
+            SuperinstructionPass pass;
+            Bytecode bytecode = compileFused(program, pass);
+            std::vector<long long> slots(program->slotCount + 1, 0);
+            BytecodeVM(std::cin, std::cout).run(bytecode, slots.data());
+        } else if (mode == "--tiered") {
+            long long threshold = argc > 3 ? std::atoll(argv[3]) : 1000;
+            TieredExecutor tiered(std::cin, std::cout, threshold);
+            tiered.run(ast.get());
+            std::cout.flush();
+            tiered.report(std::cerr);
+        } else if (mode == "--batch" && argc > 3) {
+            // One input set per line; prints one line of outputs per set
+            std::ifstream file(argv[3]);
+            std::vector<std::string> inputs;
+            std::string line;
+            while (std::getline(file, line)) inputs.push_back(line);
+            auto program = dynamic_cast<ProgramNode*>(ast.get());
+            for (std::string& output : BatchExecutor(program, *availableKernels()[0]).run(inputs)) {
+                if (!output.empty()) output.pop_back();
+                std::replace(output.begin(), output.end(), '\n', ' ');
+                std::cout << output << '\n';
+            }
+        } else if (mode == "--emit-image" && argc > 3) {
+            auto program = dynamic_cast<ProgramNode*>(ast.get());
+            SuperinstructionPass pass;
+            if (!writeImage(argv[3], program, compileFused(program, pass))) {
+                std::cerr << "Error: cannot write " << argv[3] << "\n";
+                return 1;
+            }
+        } else if (mode == "--bench-image") {
+            if (!benchmarkImage(argv[0], argv[1])) return 1;
+        } else if (mode == "--bench-bytecode") {
+            benchmarkBytecode(ast.get());
+        } else if (mode == "--bench-batch") {
+            benchmarkBatch(ast.get(), argc > 3 ? std::atoll(argv[3]) : 100000);
+        } else if (mode == "--emit-c" && argc > 3) {
+            std::ofstream out(argv[3]);
+            CCodeGenerator().generate(ast.get(), out);
+        } else if (mode == "--check-c" && argc > 3) {
+            if (!checkBackends(ast.get(), argv[3])) return 1;
+        } else if (mode == "--bench") {
+            benchmark(ast.get());
+        } else {
+            std::cerr << "Unknown option: " << mode << "\n";
+            return 1;
+        }
+        return 0;
+    }
     
     std::cout << "=== Tokens ===\n";
     for (const auto& t : tokens) t.print();
@@ -3,6 +3,10 @@
 #include <vector>
 #include <regex>
 #include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
 using namespace std;
 
 
@@ -16,13 +20,45 @@ vector<pair<string, string>> token_rules = {
 }; 
 
 
+// Small integer ids for the token texts and classes the parser looks at
+enum TokenKind {
+    T_PROGRAM, T_END_PROGRAM, T_VAR, T_START, T_END, T_PRINT, T_READ, T_IF, T_ITERATION, T_PUT,
+    T_ASSIGN, T_LESS, T_GREATER, T_EQUAL, T_PLUS, T_MINUS,
+    T_SEMICOLON, T_LPAREN, T_RPAREN, T_LBRACE, T_RBRACE,
+    T_IDENTIFIER, T_NUMBER, T_OTHER
+};
+
+typedef unsigned int TokenSet;
+
+constexpr TokenSet bit(TokenKind kind) {
+    return 1u << kind;
+}
+
+
 struct Token {
     string value;
     string type;
     int line;
+    TokenKind id = T_OTHER;   // kind of the text, or of the class for plain names and numbers
+    TokenSet kinds = 0;       // bit of the text kind | bit of the class kind
 };
 
 
+// Fills id and kinds once, so recovery never compares strings
+void classify(Token& token) {
+    static const unordered_map<string, TokenKind> texts = {
+        {"Program", T_PROGRAM}, {"end", T_END_PROGRAM}, {"Var", T_VAR}, {"Start", T_START}, {"End", T_END},
+        {"Print", T_PRINT}, {"Read", T_READ}, {"If", T_IF}, {"Iteration", T_ITERATION}, {"Put", T_PUT},
+        {"=", T_ASSIGN}, {"<", T_LESS}, {">", T_GREATER}, {"==", T_EQUAL}, {"+", T_PLUS}, {"-", T_MINUS},
+        {";", T_SEMICOLON}, {"(", T_LPAREN}, {")", T_RPAREN}, {"{", T_LBRACE}, {"}", T_RBRACE}
+    };
+    TokenKind type_kind = token.type == "IDENTIFIER" ? T_IDENTIFIER : token.type == "NUMBER" ? T_NUMBER : T_OTHER;
+    auto it = texts.find(token.value);
+    token.id = it != texts.end() ? it->second : type_kind;
+    token.kinds = bit(token.id) | bit(type_kind);
+}
+
+
 vector<Token> lexers(string code) {
     int position = 0;
     int line = 1;
@@ -46,6 +82,7 @@ vector<Token> lexers(string code) {
                 // Add token
                 if (token_rules[i].first != "BWS") {
                     tokens.push_back({match[1], token_rules[i].first, line});
+                    classify(tokens.back());
                 }
                 // push position
                 position += match.length(0);
@@ -57,6 +94,7 @@ vector<Token> lexers(string code) {
 
         if (!matched) {
             tokens.push_back({string(1, code[position]), "ERROR", line});
+            classify(tokens.back());
             position++;
         }
     }
@@ -106,13 +144,17 @@ bool error = false;
 
 
 void error_print(string message) {
+    if (currentIndex >= tokens.size()) {
+        cout << "line " << (tokens.empty() ? 0 : tokens.back().line) << ": " << message << " but it's <end of input>\n";
+        return;
+    }
     cout << "line " << tokens[currentIndex].line << ": " << message << " but it's <" << tokens[currentIndex].value << ">\n";
 }
 
 
-bool match(Token expected, string error_text) {
-    if (expected.type != "NUMBER" && expected.type != "IDENTIFIER") {
-        if (currentIndex < tokens.size() && tokens[currentIndex].value == expected.value) {
+bool match(TokenKind expected, const char* error_text) {
+    if (expected != T_NUMBER && expected != T_IDENTIFIER) {
+        if (currentIndex < tokens.size() && tokens[currentIndex].id == expected) {
             //cout << tokens[currentIndex].line << ": " << endl; //
             currentIndex ++;
             return true;
@@ -122,7 +164,7 @@ bool match(Token expected, string error_text) {
         return false;
     }
     else {
-        if (currentIndex < tokens.size() && tokens[currentIndex].type == expected.type) {
+        if (currentIndex < tokens.size() && (tokens[currentIndex].kinds & bit(expected))) {
             //cout << tokens[currentIndex].line << ": " << endl; //
             currentIndex ++;
             return true;
@@ -134,12 +176,28 @@ bool match(Token expected, string error_text) {
 }
 
 
-void sync(vector<string> followSet) {
+// Synchronizing sets for panic-mode recovery, one per nonterminal
+constexpr TokenSet STATEMENT_START = bit(T_START) | bit(T_IF) | bit(T_READ) | bit(T_PRINT) | bit(T_PUT) | bit(T_ITERATION);
+constexpr TokenSet SYNC_S = bit(T_PROGRAM);
+constexpr TokenSet SYNC_VARS = bit(T_START);
+constexpr TokenSet SYNC_BLOCK = (STATEMENT_START & ~bit(T_START)) | bit(T_END_PROGRAM) | bit(T_END);
+constexpr TokenSet SYNC_STATES = bit(T_END);
+constexpr TokenSet SYNC_STATEMENT = STATEMENT_START | bit(T_END);
+constexpr TokenSet SYNC_O = bit(T_NUMBER) | bit(T_IDENTIFIER);
+constexpr TokenSet SYNC_EXPR = bit(T_SEMICOLON) | bit(T_RPAREN) | bit(T_LESS) | bit(T_GREATER) | bit(T_EQUAL);
+constexpr TokenSet SYNC_R = SYNC_EXPR | bit(T_PLUS) | bit(T_MINUS);
+
+
+// True when the current token's text is in the set
+bool at(TokenSet set) {
+    return bit(tokens[currentIndex].id) & set;
+}
+
+
+void sync(TokenSet followSet) {
     while (currentIndex < tokens.size()) {
-        for (string follow : followSet) {
-            if ((tokens[currentIndex].value == follow) || (tokens[currentIndex].type == follow)) {
-                return;
-            }
+        if (tokens[currentIndex].kinds & followSet) {
+            return;
         }
         if (currentIndex + 1 >= tokens.size()) return;
         currentIndex++;
@@ -170,18 +228,18 @@ bool s() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Program") {
-        match(Token{"Program", "KEYWORD"}, "it must be <Program>");
+    if (tokens[currentIndex].id == T_PROGRAM) {
+        match(T_PROGRAM, "it must be <Program>");
         if (!vars()){return false;}
         if (!block()) {return false;}
-        match(Token{"end", "KEYWORD"}, "it must be <end>");
+        match(T_END_PROGRAM, "it must be <end>");
         return true;
     }
     
     else {
         error = true;
         error_print("Expected <Program> at the beginning");
-        sync({"Program"});
+        sync(SYNC_S);
         return true;
     }
 }
@@ -194,16 +252,16 @@ bool vars() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Var") {
-        match(Token{"Var", "KEYWORD"}, "it must be <Var>");
-        match(Token{"", "IDENTIFIER"}, "it must be <IDENTIFIER>");
-        match(Token{";", "PUNCTUATION"}, "it must be <;>");
+    if (tokens[currentIndex].id == T_VAR) {
+        match(T_VAR, "it must be <Var>");
+        match(T_IDENTIFIER, "it must be <IDENTIFIER>");
+        match(T_SEMICOLON, "it must be <;>");
         if (!vars()){return false;}
         
         return true;
     }
 
-    else if (tokens[currentIndex].value == "Start"){
+    else if (tokens[currentIndex].id == T_START){
         return true;
     }
 
@@ -211,7 +269,7 @@ bool vars() {
         error = true;
         //currentIndex ++;
         error_print("Expected 'Var' or 'Start");
-        sync({"Start"});
+        sync(SYNC_VARS);
         return true;
     }
 }
@@ -224,24 +282,21 @@ bool block() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Start"){
-        match(Token{"Start", "KEYWORD"}, "it must be <Start>");
+    if (tokens[currentIndex].id == T_START){
+        match(T_START, "it must be <Start>");
         if (!states()) {return false;}
-        match(Token{"End", "KEYWORD"}, "it must be <End>");
+        match(T_END, "it must be <End>");
         
         return true;
     }
     else {
         error = true;
-        vector<string> follow = {"If", "Read", "Print", "Put", "Iteration", "end", "End"};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_BLOCK)) {
+            return true;
         }
         //currentIndex ++;
         error_print("Expected <Start> for block definition");
-        sync({"If", "Read", "Print", "Put", "Iteration", "end", "End"});
+        sync(SYNC_BLOCK);
         return true;
     }
 }
@@ -261,29 +316,26 @@ bool state() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Start") {return block();}
+    if (tokens[currentIndex].id == T_START) {return block();}
         
-    else if (tokens[currentIndex].value == "If") {return _if();}
+    else if (tokens[currentIndex].id == T_IF) {return _if();}
 
-    else if (tokens[currentIndex].value == "Read") {return in();}
+    else if (tokens[currentIndex].id == T_READ) {return in();}
 
-    else if (tokens[currentIndex].value == "Print") {return out();}
+    else if (tokens[currentIndex].id == T_PRINT) {return out();}
 
-    else if (tokens[currentIndex].value == "Put") {return assign();}
+    else if (tokens[currentIndex].id == T_PUT) {return assign();}
 
-    else if (tokens[currentIndex].value == "Iteration") {return loop();}
+    else if (tokens[currentIndex].id == T_ITERATION) {return loop();}
     
     else {
         error = true;
-        vector<string> follow = {"End"};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATES)) {
+            return true;
         }
         //currentIndex ++;
         error_print("Unknown statement");
-        sync({"End"});
+        sync(SYNC_STATES);
         return true;
     }
 }
@@ -296,13 +348,13 @@ bool m_states() {
         return false;
     }
 
-    string token = tokens[currentIndex].value; 
+    TokenKind token = tokens[currentIndex].id; 
     
-    if (token=="Start" || token=="If" || token=="Read" || token=="Print" || token=="Put" || token=="Iteration") {    
+    if (token == T_START || token == T_IF || token == T_READ || token == T_PRINT || token == T_PUT || token == T_ITERATION) {    
         return states();
     }
     
-    else if (token == "End") {
+    else if (token == T_END) {
         return true;
     }        
 
@@ -316,7 +368,7 @@ bool m_states() {
         }*/
         //currentIndex ++;
         error_print("Expected a statement or <End>");
-        sync({"End"}); 
+        sync(SYNC_STATES); 
         return true;
     }
 }
@@ -329,26 +381,23 @@ bool out() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Print") {
-        match(Token{"Print", "KEYWORD"}, "it must be <Print>");
-        match(Token{"(", "PUNCTUATION"}, "it must be <(>");
+    if (tokens[currentIndex].id == T_PRINT) {
+        match(T_PRINT, "it must be <Print>");
+        match(T_LPAREN, "it must be <(>");
         if (!expr()) {return false;}
-        match(Token{")", "PUNCTUATION"}, "it must be <)>");
-        match(Token{";", "PUNCTUATION"}, "it must be <;>");
+        match(T_RPAREN, "it must be <)>");
+        match(T_SEMICOLON, "it must be <;>");
                             
         return true;
     }
     else {
         error = true;
-        vector<string> follow = {"Start", "If", "Read", "Print", "Put", "Iteration", "End", ";"};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATEMENT | bit(T_SEMICOLON))) {
+            return true;
         }
         //currentIndex ++;
         error_print("it must be <Print>");
-        sync({"Start", "If", "Read", "Print", "Put", "Iteration", "End"});
+        sync(SYNC_STATEMENT);
         return true;
     }
 }
@@ -361,26 +410,23 @@ bool in() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Read") {
-        match(Token{"Read", "KEYWORD"}, "it must be <Read>");
-        match(Token{"(", "PUNCTUATION"}, "it must be <(>");
-        match(Token{"", "IDENTIFIER"}, "it must be <IDENTIFIER>");
-        match(Token{")", "PUNCTUATION"}, "it must be <)>");
-        match(Token{";", "PUNCTUATION"}, "it must be <;>");
+    if (tokens[currentIndex].id == T_READ) {
+        match(T_READ, "it must be <Read>");
+        match(T_LPAREN, "it must be <(>");
+        match(T_IDENTIFIER, "it must be <IDENTIFIER>");
+        match(T_RPAREN, "it must be <)>");
+        match(T_SEMICOLON, "it must be <;>");
         return true;
     }
 
     else {
         error = true;
-        vector<string> follow = {"Start", "If", "Read", "Print", "Put", "Iteration", "End", ";"};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATEMENT | bit(T_SEMICOLON))) {
+            return true;
         }
         error_print("it must be <Read>");
         //currentIndex ++;
-        sync({"Start", "If", "Read", "Print", "Put", "Iteration", "End"});
+        sync(SYNC_STATEMENT);
         return true;
     }
 }
@@ -393,31 +439,28 @@ bool _if() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "If") {
-        match(Token{"If", "KEYWORD"}, "it must be <If>");
-        match(Token{"(", "PUNCTUATION"}, "it must be <(>");
+    if (tokens[currentIndex].id == T_IF) {
+        match(T_IF, "it must be <If>");
+        match(T_LPAREN, "it must be <(>");
         if (!expr()) {return false;}
         if (!o()) {return false;}
         if (!expr()) {return false;}
-        match(Token{")", "PUNCTUATION"}, "it must be <)>");
-        match(Token{"{", "PUNCTUATION"}, "it must be <{>");
+        match(T_RPAREN, "it must be <)>");
+        match(T_LBRACE, "it must be <{>");
         if (!state()) {return false;}
-        match(Token{"}", "PUNCTUATION"}, "it must be <}>");
+        match(T_RBRACE, "it must be <}>");
 
         return true;
     }
 
     else {
         error = true;
-        vector<string> follow = {"Start", "If", "Read", "Print", "Put", "Iteration", "End", ""};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATEMENT)) {
+            return true;
         }
         error_print("it must be <If>");
         //currentIndex ++;
-        sync({"Start", "If", "Read", "Print", "Put", "Iteration", "End"});
+        sync(SYNC_STATEMENT);
         return true;
     }
 }
@@ -430,30 +473,27 @@ bool loop() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Iteration") {
-        match(Token{"Iteration", "KEYWORD"}, "it must be <Iteration>");
-        match(Token{"(", "PUNCTUATION"}, "it must be <(>");
+    if (tokens[currentIndex].id == T_ITERATION) {
+        match(T_ITERATION, "it must be <Iteration>");
+        match(T_LPAREN, "it must be <(>");
         if (!expr()) {return false;}
         if (!o()) {return false;}
         if (!expr()) {return false;}
-        match(Token{")", "PUNCTUATION"}, "it must be <)>");
-        match(Token{"{", "PUNCTUATION"}, "it must be <{>");
+        match(T_RPAREN, "it must be <)>");
+        match(T_LBRACE, "it must be <{>");
         if (!state()) {return false;}
-        match(Token{"}", "PUNCTUATION"}, "it must be <}>");
+        match(T_RBRACE, "it must be <}>");
         return true;
     }
     
     else {
         error = true;
-        vector<string> follow = {"Start", "If", "Read", "Print", "Put", "Iteration", "End", ""};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATEMENT)) {
+            return true;
         }
         error_print("it must be <Iteration>");
         //currentIndex ++;
-        sync({"Start", "If", "Read", "Print", "Put", "Iteration", "End"});
+        sync(SYNC_STATEMENT);
         return true;
     }
 }
@@ -466,26 +506,23 @@ bool assign() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "Put") {
-        match(Token{"Put", "KEYWORD"}, "it must be <Put>");
-        match(Token{"", "IDENTIFIER"}, "it must be <IDENTIFIER>");
-        match(Token{"=", "OPERATOR"}, "it must be <=>");
+    if (tokens[currentIndex].id == T_PUT) {
+        match(T_PUT, "it must be <Put>");
+        match(T_IDENTIFIER, "it must be <IDENTIFIER>");
+        match(T_ASSIGN, "it must be <=>");
         if (!expr()) {return false;}
-        match(Token{";", "PUNCTUATION"}, "it must be <;>");
+        match(T_SEMICOLON, "it must be <;>");
         return true;
         }
 
     else {
         error = true;
-        vector<string> follow = {"Start", "If", "Read", "Print", "Put", "Iteration", "End", ";"};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_STATEMENT | bit(T_SEMICOLON))) {
+            return true;
         }
         error_print("it must be <Put>");
         //currentIndex ++;
-        sync({"Start", "If", "Read", "Print", "Put", "Iteration", "End"});
+        sync(SYNC_STATEMENT);
         return true;
     }
 }
@@ -499,34 +536,31 @@ bool o() {
         return false;
     }
 
-    if (tokens[currentIndex].value == "<") {
-        match(Token{"<", "OPERATOR"}, "it must be <OPERATOR>");
+    if (tokens[currentIndex].id == T_LESS) {
+        match(T_LESS, "it must be <OPERATOR>");
         return true;
     }
     
-    else if (tokens[currentIndex].value == ">") {
-        match(Token{">", "OPERATOR"}, "it must be <OPERATOR>");
+    else if (tokens[currentIndex].id == T_GREATER) {
+        match(T_GREATER, "it must be <OPERATOR>");
         return true;
     }
     
-    else if (tokens[currentIndex].value == "==") {
-        match(Token{"==", "OPERATOR"}, "it must be <OPERATOR>");
+    else if (tokens[currentIndex].id == T_EQUAL) {
+        match(T_EQUAL, "it must be <OPERATOR>");
         return true;
     }
         //return true;
 
     else {
         error = true;
-        vector<string> follow = {"NUMBER", "IDENTIFIER"};
-        for (string f : follow) {
-            if (tokens[currentIndex].type == f) {
-                return true;
-            }
+        if (tokens[currentIndex].kinds & SYNC_O) {
+            return true;
         }
         error_print("it must be <OPERATOR>");
         //currentIndex ++;
         error_print("it must be <OPERATOR>");
-        sync({"NUMBER", "IDENTIFIER"});
+        sync(SYNC_O);
         return true;
     }
 }
@@ -539,21 +573,18 @@ bool expr() {
         return false;
     }
 
-    if (tokens[currentIndex].type == "NUMBER" || tokens[currentIndex].type == "IDENTIFIER") {
+    if ((tokens[currentIndex].kinds & bit(T_NUMBER)) || (tokens[currentIndex].kinds & bit(T_IDENTIFIER))) {
         return r() && expr_p();
     }
 
     else {
         error = true;
-        vector<string> follow = {";", ")", "<", ">", "=="};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_EXPR)) {
+            return true;
         }
         error_print("Expected an expression");
         //currentIndex ++;
-        sync({";", ")", "<", ">", "=="});
+        sync(SYNC_EXPR);
         return true;
     }
 }
@@ -566,24 +597,24 @@ bool expr_p() {
         return false;
     }
 
-    string token = tokens[currentIndex].value;
-    if (token == "+") {
-        match(Token{"+", "OPERATOR"}, "");
+    TokenKind token = tokens[currentIndex].id;
+    if (token == T_PLUS) {
+        match(T_PLUS, "");
         if (!r()) {return false;}
         if (!expr_p()){return false;}
         
         return true;         
     }
         
-    else if (token == "-") {
-        match(Token{"-", "OPERATOR"}, "");
+    else if (token == T_MINUS) {
+        match(T_MINUS, "");
         if (!r()) {return false;}
         if (!expr_p()){return false;}
         
         return true;
     }
     
-    else if (token==")" || token==";" || token=="<" || token==">" || token=="==") {
+    else if (token == T_RPAREN || token == T_SEMICOLON || token == T_LESS || token == T_GREATER || token == T_EQUAL) {
         return true; 
     }
 
@@ -598,7 +629,7 @@ bool expr_p() {
         //currentIndex ++;
         error_print("Expected <+>, <->, or end of expression");
         error_print("it must be <OPERATOR>");
-        sync({";", ")", "<", ">", "=="});
+        sync(SYNC_EXPR);
         return true;
     }
 }
@@ -611,33 +642,488 @@ bool r() {
         return false;
     }
 
-    if (tokens[currentIndex].type == "NUMBER") {
-        match(Token{"", "NUMBER"}, "");
+    if ((tokens[currentIndex].kinds & bit(T_NUMBER))) {
+        match(T_NUMBER, "");
         return true;
     }
     
-    else if (tokens[currentIndex].type == "IDENTIFIER") {
-        match(Token{"", "IDENTIFIER"}, "");
+    else if ((tokens[currentIndex].kinds & bit(T_IDENTIFIER))) {
+        match(T_IDENTIFIER, "");
         return true;
     }
     
     else {
         error = true;
-        vector<string> follow = {";", ")", "+", "-", "<", ">", "=="};
-        for (string f : follow) {
-            if (tokens[currentIndex].value == f) {
-                return true;
-            }
+        if (at(SYNC_R)) {
+            return true;
         }
         //currentIndex ++;
         error_print("it must be <NUMBER> or <IDENTIFIER>");
-        sync({";", ")", "+", "-", "<", ">", "=="});
+        sync(SYNC_R);
         return true;
     }
 }
 
+// #######################################################################
+// LL(1) parse engine: grammar.txt -> FIRST/FOLLOW -> table -> explicit stack
+
+struct Grammar {
+    vector<string> terminals;          // "$" is always the last one
+    vector<string> nonterminals;       // nonterminal i is symbol terminals.size() + i
+    vector<int> lhs;                   // production -> nonterminal
+    vector<vector<int>> rhs;           // production -> symbols, left to right
+    vector<vector<int>> reversed_rhs;  // the same, ready to be pushed on the stack
+    vector<bool> nullable;
+    vector<vector<bool>> first;        // nonterminal -> terminal set
+    vector<vector<bool>> follow;
+    vector<int> table;                 // nonterminal * terminals.size() + terminal -> production or -1
+    unordered_map<string, int> literal_terminals;
+    vector<int> kind_terminals;        // TokenKind -> terminal, -1 for texts the grammar does not use
+    bool unkinded_literals = false;    // some terminal text has no TokenKind and needs a string lookup
+    int identifier = -1;
+    int integer = -1;
+    int end = -1;
+};
+
+
+bool is_terminal(const Grammar& g, int symbol) {
+    return symbol < (int)g.terminals.size();
+}
+
+
+string symbol_name(const Grammar& g, int symbol) {
+    if (is_terminal(g, symbol)) {
+        return g.terminals[symbol];
+    }
+    return "<" + g.nonterminals[symbol - g.terminals.size()] + ">";
+}
+
+
+bool read_grammar(string path, Grammar& g) {
+    ifstream file(path);
+    if (!file) {
+        cout << "Error: cannot open " << path << endl;
+        return false;
+    }
+
+    // First pass: every left hand side is a nonterminal, in order of appearance
+    vector<vector<string>> lines;
+    string line;
+    while (getline(file, line)) {
+        istringstream words(line);
+        vector<string> parts;
+        string word;
+        while (words >> word) {
+            parts.push_back(word);
+        }
+        if (parts.empty() || parts[0][0] == '#') {
+            continue;
+        }
+        if (parts.size() < 2 || parts[1] != "=>" || parts[0].size() < 3 || parts[0].front() != '<' || parts[0].back() != '>') {
+            cout << "Error: bad grammar line <" << line << ">" << endl;
+            return false;
+        }
+        g.nonterminals.push_back(parts[0].substr(1, parts[0].size() - 2));
+        lines.push_back(parts);
+    }
+
+    // Second pass: split alternatives, terminals are numbered as they are met
+    vector<vector<string>> bodies;
+    for (int n = 0; n < (int)lines.size(); n++) {
+        vector<string> body;
+        for (int i = 2; i <= (int)lines[n].size(); i++) {
+            if (i == (int)lines[n].size() || lines[n][i] == "|") {
+                g.lhs.push_back(n);
+                bodies.push_back(body);
+                body.clear();
+            }
+            else if (lines[n][i] != "Epsilon") {
+                body.push_back(lines[n][i]);
+                string word = lines[n][i];
+                bool nonterminal = word.size() > 2 && word.front() == '<' && word.back() == '>';
+                if (!nonterminal && find(g.terminals.begin(), g.terminals.end(), word) == g.terminals.end()) {
+                    g.terminals.push_back(word);
+                }
+            }
+        }
+    }
+    g.terminals.push_back("$");
+    int terminal_count = g.terminals.size();
+    for (int t = 0; t < terminal_count; t++) {
+        if (g.terminals[t] == "Identifier") {g.identifier = t;}
+        else if (g.terminals[t] == "Integer") {g.integer = t;}
+        else if (g.terminals[t] == "$") {g.end = t;}
+        else {g.literal_terminals[g.terminals[t]] = t;}
+    }
+    g.kind_terminals.assign(T_OTHER + 1, -1);
+    for (auto& literal : g.literal_terminals) {
+        Token token{literal.first, "", 0};
+        classify(token);
+        if (token.id != T_OTHER) {g.kind_terminals[token.id] = literal.second;}
+        else {g.unkinded_literals = true;}
+    }
+    g.kind_terminals[T_IDENTIFIER] = g.identifier;
+    g.kind_terminals[T_NUMBER] = g.integer;
+
+    for (vector<string>& body : bodies) {
+        vector<int> symbols;
+        for (string& word : body) {
+            if (word.size() > 2 && word.front() == '<' && word.back() == '>') {
+                auto it = find(g.nonterminals.begin(), g.nonterminals.end(), word.substr(1, word.size() - 2));
+                if (it == g.nonterminals.end()) {
+                    cout << "Error: nonterminal " << word << " has no production" << endl;
+                    return false;
+                }
+                symbols.push_back(terminal_count + (it - g.nonterminals.begin()));
+            }
+            else {
+                symbols.push_back(find(g.terminals.begin(), g.terminals.end(), word) - g.terminals.begin());
+            }
+        }
+        g.rhs.push_back(symbols);
+        g.reversed_rhs.push_back(vector<int>(symbols.rbegin(), symbols.rend()));
+    }
+    return true;
+}
+
+
+// Adds FIRST(symbols[from..]) to result, returns true when all of them can vanish
+bool first_of(const Grammar& g, const vector<int>& symbols, int from, vector<bool>& result) {
+    for (int i = from; i < (int)symbols.size(); i++) {
+        if (is_terminal(g, symbols[i])) {
+            result[symbols[i]] = true;
+            return false;
+        }
+        int n = symbols[i] - g.terminals.size();
+        for (int t = 0; t < (int)g.terminals.size(); t++) {
+            if (g.first[n][t]) {result[t] = true;}
+        }
+        if (!g.nullable[n]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool merge(vector<bool>& into, const vector<bool>& from) {
+    bool changed = false;
+    for (int t = 0; t < (int)into.size(); t++) {
+        if (from[t] && !into[t]) {
+            into[t] = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+
+bool build_ll1(Grammar& g) {
+    int terminal_count = g.terminals.size();
+    int nonterminal_count = g.nonterminals.size();
+    g.nullable.assign(nonterminal_count, false);
+    g.first.assign(nonterminal_count, vector<bool>(terminal_count, false));
+    g.follow.assign(nonterminal_count, vector<bool>(terminal_count, false));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < (int)g.rhs.size(); p++) {
+            vector<bool> first(terminal_count, false);
+            bool vanishes = first_of(g, g.rhs[p], 0, first);
+            changed |= merge(g.first[g.lhs[p]], first);
+            if (vanishes && !g.nullable[g.lhs[p]]) {
+                g.nullable[g.lhs[p]] = true;
+                changed = true;
+            }
+        }
+    }
+
+    g.follow[0][g.end] = true;
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < (int)g.rhs.size(); p++) {
+            for (int i = 0; i < (int)g.rhs[p].size(); i++) {
+                if (is_terminal(g, g.rhs[p][i])) {
+                    continue;
+                }
+                vector<bool> rest(terminal_count, false);
+                bool vanishes = first_of(g, g.rhs[p], i + 1, rest);
+                int n = g.rhs[p][i] - terminal_count;
+                changed |= merge(g.follow[n], rest);
+                if (vanishes) {
+                    changed |= merge(g.follow[n], g.follow[g.lhs[p]]);
+                }
+            }
+        }
+    }
+
+    bool ll1 = true;
+    g.table.assign(nonterminal_count * terminal_count, -1);
+    for (int p = 0; p < (int)g.rhs.size(); p++) {
+        vector<bool> select(terminal_count, false);
+        if (first_of(g, g.rhs[p], 0, select)) {
+            merge(select, g.follow[g.lhs[p]]);
+        }
+        for (int t = 0; t < terminal_count; t++) {
+            if (!select[t]) {
+                continue;
+            }
+            int& entry = g.table[g.lhs[p] * terminal_count + t];
+            if (entry != -1 && entry != p) {
+                cout << "Error: LL(1) conflict in <" << g.nonterminals[g.lhs[p]] << "> on " << g.terminals[t]
+                     << " between productions " << entry + 1 << " and " << p + 1 << endl;
+                ll1 = false;
+            }
+            entry = p;
+        }
+    }
+    return ll1;
+}
+
+
+void print_ll1(const Grammar& g) {
+    int terminal_count = g.terminals.size();
+    for (int p = 0; p < (int)g.rhs.size(); p++) {
+        cout << p + 1 << ". <" << g.nonterminals[g.lhs[p]] << "> =>";
+        for (int symbol : g.rhs[p]) {
+            cout << " " << symbol_name(g, symbol);
+        }
+        if (g.rhs[p].empty()) {
+            cout << " Epsilon";
+        }
+        cout << "\n";
+    }
+    cout << "\n";
+    for (int n = 0; n < (int)g.nonterminals.size(); n++) {
+        cout << "<" << g.nonterminals[n] << ">\n    FIRST  = {";
+        for (int t = 0; t < terminal_count; t++) {
+            if (g.first[n][t]) {cout << " " << g.terminals[t];}
+        }
+        if (g.nullable[n]) {cout << " Epsilon";}
+        cout << " }\n    FOLLOW = {";
+        for (int t = 0; t < terminal_count; t++) {
+            if (g.follow[n][t]) {cout << " " << g.terminals[t];}
+        }
+        cout << " }\n    TABLE  =";
+        for (int t = 0; t < terminal_count; t++) {
+            int p = g.table[n * terminal_count + t];
+            if (p != -1) {cout << " " << g.terminals[t] << ":" << p + 1;}
+        }
+        cout << "\n";
+    }
+}
+
+
+int terminal_of(const Grammar& g, int index) {
+    if (index >= (int)tokens.size()) {
+        return g.end;
+    }
+    TokenKind id = tokens[index].id;
+    if (id < T_IDENTIFIER || !g.unkinded_literals) {
+        return g.kind_terminals[id];
+    }
+    // The grammar has terminal texts the lexer has no kind for
+    auto it = g.literal_terminals.find(tokens[index].value);
+    if (it != g.literal_terminals.end()) {
+        return it->second;
+    }
+    return g.kind_terminals[id];
+}
+
+
+bool parse_ll1(const Grammar& g) {
+    int terminal_count = g.terminals.size();
+    vector<int> stack = {g.end, terminal_count};
+    currentIndex = 0;
+    int lookahead = terminal_of(g, currentIndex);
+
+    while (!stack.empty()) {
+        int top = stack.back();
+        if (is_terminal(g, top)) {
+            stack.pop_back();
+            if (top == lookahead) {
+                if (top == g.end) {
+                    break;
+                }
+                lookahead = terminal_of(g, ++currentIndex);
+            }
+            else if (top == g.end) {
+                // Input left over after <S> is complete
+                error = true;
+                error_print("Expected end of input");
+            }
+            else {
+                // Act as if the missing terminal was there
+                error = true;
+                if (lookahead == g.end) {
+                    cout << "Error: Unexpected end of expression, it must be <" << g.terminals[top] << ">" << endl;
+                    return false;
+                }
+                error_print("it must be <" + g.terminals[top] + ">");
+            }
+            continue;
+        }
+
+        int n = top - terminal_count;
+        int p = lookahead == -1 ? -1 : g.table[n * terminal_count + lookahead];
+        if (p != -1) {
+            stack.pop_back();
+            stack.insert(stack.end(), g.reversed_rhs[p].begin(), g.reversed_rhs[p].end());
+            continue;
+        }
+
+        // Panic mode: skip tokens until one can start or follow the nonterminal
+        error = true;
+        if (lookahead == g.end) {
+            cout << "Error: Unexpected end of expression in " << symbol_name(g, top) << endl;
+            return false;
+        }
+        error_print("Unexpected token for " + symbol_name(g, top));
+        while (lookahead != g.end && (lookahead == -1 || (!g.first[n][lookahead] && !g.follow[n][lookahead]))) {
+            lookahead = terminal_of(g, ++currentIndex);
+        }
+        if (lookahead == g.end || g.follow[n][lookahead]) {
+            stack.pop_back();
+        }
+    }
+    return !error;
+}
+
+
+// Repeats the statements of a small program until it has the requested number of them
+vector<Token> bench_tokens(int statements) {
+    vector<Token> body = lexers(
+        "Read (x); \n"
+        "Put y = x + 1 - z + 42; \n"
+        "If (x + 1 < y) { Print (y - x); } \n"
+        "Iteration (i > 0) { Start Put i = i - 1; Print (i); End } \n"
+    );
+    vector<Token> head = lexers("Program \nVar x; \nVar y; \nVar z; \nVar i; \nStart \n");
+    vector<Token> result = head;
+    int line = head.back().line;
+    for (int i = 0; i < statements / 4; i++) {
+        for (Token token : body) {
+            token.line += line;
+            result.push_back(token);
+        }
+        line += body.back().line;
+    }
+    result.push_back({"End", "KEYWORD", line + 1});
+    result.push_back({"end", "KEYWORD", line + 2});
+    classify(result[result.size() - 2]);
+    classify(result.back());
+    return result;
+}
+
+
+void benchmark(const Grammar& g, int statements) {
+    tokens = bench_tokens(statements);
+    cout << tokens.size() << " tokens, " << statements << " statements\n";
+
+    for (int engine = 0; engine < 2; engine++) {
+        int runs = 0;
+        bool ok = true;
+        auto start = chrono::steady_clock::now();
+        double seconds = 0;
+        while (seconds < 1.0) {
+            currentIndex = 0;
+            error = false;
+            if (engine == 0) {
+                s();
+            }
+            else {
+                parse_ll1(g);
+            }
+            ok = ok && !error && currentIndex == (int)tokens.size();
+            runs++;
+            seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        cout << (engine == 0 ? "recursive descent" : "LL(1) table     ") << "  "
+             << (long long)(tokens.size() * runs / seconds) << " tokens/sec" << (ok ? "" : "  (REJECTED)") << "\n";
+    }
+}
+
+
+// Seeds errors into a valid program: roughly one token in every `spacing` is dropped, doubled or swapped
+vector<Token> broken_tokens(const vector<Token>& valid, int spacing, unsigned int& seed) {
+    vector<Token> result;
+    for (int i = 0; i < (int)valid.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        int roll = (seed >> 8) % (3 * spacing);
+        // Keep "Program ... Start" and "End end" intact, the errors go into the block
+        if (i < 20 || i + 2 >= (int)valid.size() || roll >= 3) {
+            result.push_back(valid[i]);
+        }
+        else if (roll == 1) {
+            result.push_back(valid[i]);
+            result.push_back(valid[i]);
+        }
+        else if (roll == 2) {
+            result.push_back(valid[(seed >> 16) % valid.size()]);
+        }
+    }
+    return result;
+}
+
+
+void benchmark_recovery(int programs, int spacing) {
+    vector<Token> valid = bench_tokens(40);
+    vector<vector<Token>> corpus;
+    unsigned int seed = 12345;
+    long long token_count = 0;
+    for (int i = 0; i < programs; i++) {
+        corpus.push_back(broken_tokens(valid, spacing, seed));
+        token_count += corpus.back().size();
+    }
+    cout << programs << " programs, " << token_count << " tokens, about one error every " << spacing << " tokens\n";
+
+    // Silence the diagnostics, printing them would be all that gets measured
+    cout.setstate(ios::failbit);
+    int runs = 0, rejected = 0;
+    auto start = chrono::steady_clock::now();
+    double seconds = 0;
+    while (seconds < 1.0) {
+        for (vector<Token>& program : corpus) {
+            tokens.swap(program);
+            currentIndex = 0;
+            error = false;
+            s();
+            rejected += error;
+            tokens.swap(program);
+        }
+        runs++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    cout.clear();
+    cout << "recursive descent  " << seconds * 1000 / runs << " ms per corpus, "
+         << (long long)(programs * runs / seconds) << " programs/sec, "
+         << rejected / runs << " rejected\n";
+}
+
+
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+    Grammar grammar;
+    if (mode == "--ll1" || mode == "--table" || mode == "--bench") {
+        if (!read_grammar("grammar.txt", grammar) || !build_ll1(grammar)) {
+            return 1;
+        }
+    }
+    if (mode == "--table") {
+        print_ll1(grammar);
+        return 0;
+    }
+    if (mode == "--bench-recovery") {
+        benchmark_recovery(argc > 2 ? atoi(argv[2]) : 10000, argc > 3 ? atoi(argv[3]) : 20);
+        return 0;
+    }
+    if (mode == "--bench") {
+        benchmark(grammar, argc > 2 ? atoi(argv[2]) : 2000);
+        return 0;
+    }
 
-int main() {
     string code, temp;
     ifstream codefile("code.txt");
     while (getline(codefile, temp)) {
@@ -649,7 +1135,7 @@ int main() {
         cout << token.line << ". " << token.value << " - " << token.type << endl;
     }
     cout << "\n\n---------- Syntactic Analyzer(Parser) ----------\n\n",
-    s();
+    mode == "--ll1" ? parse_ll1(grammar) : s();
     cout <<"Error: " << error << '\n';
 
     return 0;
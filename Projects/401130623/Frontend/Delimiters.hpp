@@ -1,16 +1,22 @@
 #ifndef DELIMITERS_HPP
 #define DELIMITERS_HPP
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Delimiters
 {
 public:
+    // Spellings for OperatorTrie, which is built at compile time
+    static constexpr std::array<std::string_view, 10> list = {
+        "(" , ")" , "{" , "}" , "[" , "]" , ";" , "," , "." , ":"
+    };
+
+    // The same list as strings, copied from the array so the two agree
     static const std::vector<std::string>& getDelimiters() {
-        static std::vector<std::string> delimiters = {
-            "(" , ")" , "{" , "}" , "[" , "]" , ";" , "," , "." , ":"
-        };
+        static std::vector<std::string> delimiters(list.begin(), list.end());
         return delimiters;
     }
 };
@@ -0,0 +1,217 @@
+#ifndef KEYWORD_TABLE_HPP
+#define KEYWORD_TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// Where a keyword table keeps its arrays. The fixed one is sized by the
+// compiler so the whole table can be a constexpr; the dynamic one is sized
+// when the keyword list is loaded (see LanguageSpec.hpp).
+template <std::size_t N>
+struct FixedKeywordStorage {
+    static_assert(N > 0 && N < 256, "displacements are stored in one byte each");
+
+    template <typename T>
+    using Array = std::array<T, N>;
+    using Displacement = std::uint8_t;
+
+    template <typename T>
+    static constexpr Array<T> make(std::size_t) {
+        return {};
+    }
+};
+
+struct DynamicKeywordStorage {
+    template <typename T>
+    using Array = std::vector<T>;
+    using Displacement = std::uint32_t;
+
+    template <typename T>
+    static Array<T> make(std::size_t n) {
+        return Array<T>(n);
+    }
+};
+
+// Minimal perfect hash over a keyword list. find() hashes the lexeme
+// once, picks the only slot it can be in and compares it there: the
+// result is the keyword's position in the list, or -1. Lookups allocate
+// nothing and cost the same for 10 keywords or 10,000.
+// Like gperf, the hash only samples the length and three characters;
+// keyword lists those cannot tell apart fall back to hashing every byte.
+//
+//     static constexpr KeywordTable<3> table({"if", "else", "while"});
+//     table.find("else") == 1
+//
+// The low half of the hash picks a bucket, the high half a slot, and the
+// slot is shifted by the displacement stored for the bucket ("hash and
+// displace"). Buckets are placed largest first; if some bucket fits
+// nowhere the whole table is rebuilt with the next seed.
+template <typename Storage>
+class BasicKeywordTable
+{
+public:
+    using Words = typename Storage::template Array<std::string_view>;
+
+    // The table keeps views into words, which must outlive it
+    constexpr explicit BasicKeywordTable(const Words& words) : count(words.size()) {
+        if (count == 0) {
+            return;
+        }
+        for (int full = 0; full < 2; ++full) {
+            for (std::uint64_t seed = 0; seed < 64; ++seed) {
+                if (build(words, seed, full)) {
+                    return;
+                }
+            }
+        }
+        throw std::logic_error("KeywordTable: duplicate keywords or no perfect hash found");
+    }
+
+    constexpr int find(std::string_view word) const {
+        if (count == 0) {
+            return -1;
+        }
+        std::uint64_t h = hash(word, seed, fullHash);
+        std::size_t slot = place(h, displacements[bucket(h)]);
+        return words[slot] == word ? indices[slot] : -1;
+    }
+
+    constexpr bool contains(std::string_view word) const {
+        return find(word) != -1;
+    }
+
+    constexpr std::size_t size() const {
+        return count;
+    }
+
+private:
+    using Displacement = typename Storage::Displacement;
+
+    std::size_t count = 0;
+    Words words{};
+    typename Storage::template Array<int> indices{};
+    typename Storage::template Array<Displacement> displacements{};
+    std::uint64_t seed = 0;
+    bool fullHash = false;
+
+    static constexpr std::uint64_t mix(std::uint64_t h, std::uint64_t value) {
+        return (h ^ value) * 1099511628211ull;
+    }
+
+    // FNV-1a with the seed folded into the offset basis, then a finalizer
+    // so the high bits used by place() depend on every input
+    static constexpr std::uint64_t hash(std::string_view word, std::uint64_t seed, bool full) {
+        std::uint64_t h = 14695981039346656037ull ^ (seed * 0x9e3779b97f4a7c15ull);
+        if (full) {
+            for (char c : word) {
+                h = mix(h, static_cast<unsigned char>(c));
+            }
+        }
+        else if (!word.empty()) {
+            h ^= word.size() | static_cast<std::uint64_t>(static_cast<unsigned char>(word.front())) << 8
+                | static_cast<std::uint64_t>(static_cast<unsigned char>(word[word.size() / 2])) << 16
+                | static_cast<std::uint64_t>(static_cast<unsigned char>(word.back())) << 24;
+        }
+        h *= 0xbf58476d1ce4e5b9ull;
+        return h ^ (h >> 29);
+    }
+
+    // Both map 32 bits of the hash onto [0, count) with a multiply instead of a division
+    constexpr std::size_t bucket(std::uint64_t h) const {
+        return static_cast<std::size_t>((h & 0xffffffffu) * count >> 32);
+    }
+
+    constexpr std::size_t place(std::uint64_t h, std::size_t d) const {
+        std::size_t slot = static_cast<std::size_t>((h >> 32) * count >> 32) + d;
+        return slot >= count ? slot - count : slot;
+    }
+
+    constexpr bool build(const Words& keys, std::uint64_t candidate, bool full) {
+        auto hashes = Storage::template make<std::uint64_t>(count);
+        auto bucketSize = Storage::template make<std::size_t>(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            hashes[i] = hash(keys[i], candidate, full);
+            bucketSize[bucket(hashes[i])]++;
+        }
+
+        // Keys grouped by bucket: bucket b owns members[first[b] .. first[b] + bucketSize[b])
+        auto first = Storage::template make<std::size_t>(count);
+        auto members = Storage::template make<std::size_t>(count);
+        std::size_t largest = 0;
+        for (std::size_t b = 0, at = 0; b < count; ++b) {
+            first[b] = at;
+            at += bucketSize[b];
+            largest = bucketSize[b] > largest ? bucketSize[b] : largest;
+        }
+        {
+            auto filled = Storage::template make<std::size_t>(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t b = bucket(hashes[i]);
+                members[first[b] + filled[b]++] = i;
+            }
+        }
+
+        // Bucket ids, largest bucket first
+        auto order = Storage::template make<std::size_t>(count);
+        std::size_t ordered = 0;
+        for (std::size_t size = largest; size > 0; --size) {
+            for (std::size_t b = 0; b < count; ++b) {
+                if (bucketSize[b] == size) {
+                    order[ordered++] = b;
+                }
+            }
+        }
+
+        auto taken = Storage::template make<bool>(count);
+        auto chosen = Storage::template make<Displacement>(count);
+        for (std::size_t k = 0; k < ordered; ++k) {
+            std::size_t b = order[k];
+            bool placed = false;
+            for (std::size_t d = 0; d < count && !placed; ++d) {
+                // Every key of the bucket needs a free slot, and a slot of its own
+                placed = true;
+                for (std::size_t m = first[b]; m < first[b] + bucketSize[b] && placed; ++m) {
+                    std::size_t slot = place(hashes[members[m]], d);
+                    placed = !taken[slot];
+                    for (std::size_t other = first[b]; other < m && placed; ++other) {
+                        placed = place(hashes[members[other]], d) != slot;
+                    }
+                }
+                if (placed) {
+                    for (std::size_t m = first[b]; m < first[b] + bucketSize[b]; ++m) {
+                        taken[place(hashes[members[m]], d)] = true;
+                    }
+                    chosen[b] = static_cast<Displacement>(d);
+                }
+            }
+            if (!placed) {
+                return false;
+            }
+        }
+
+        words = Storage::template make<std::string_view>(count);
+        indices = Storage::template make<int>(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t slot = place(hashes[i], chosen[bucket(hashes[i])]);
+            words[slot] = keys[i];
+            indices[slot] = static_cast<int>(i);
+        }
+        displacements = chosen;
+        seed = candidate;
+        fullHash = full;
+        return true;
+    }
+};
+
+// Built by the compiler from a fixed list
+template <std::size_t N>
+using KeywordTable = BasicKeywordTable<FixedKeywordStorage<N>>;
+
+// Built at startup from a list read at runtime
+using DynamicKeywordTable = BasicKeywordTable<DynamicKeywordStorage>;
+
+#endif // KEYWORD_TABLE_HPP
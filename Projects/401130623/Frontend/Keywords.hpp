@@ -1,21 +1,29 @@
 #ifndef KEYWORDS_HPP
 #define KEYWORDS_HPP
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <KeywordTable.hpp>
 
 class Keywords
 {
 public:
-    static const std::vector<std::string>& getKeywords() {
-        static std::vector<std::string> keywords = {
-            "float" , "int" , "return" , "if" , "else" ,
-            "for" , "while" , "do" , "char" , "double" ,
-            "string" , "let"
+    static constexpr std::array<std::string_view, 12> list = {
+        "float" , "int" , "return" , "if" , "else" ,
+        "for" , "while" , "do" , "char" , "double" ,
+        "string" , "let"
+    };
 
-        };
+    // The same list as strings, copied from the array so the two agree
+    static const std::vector<std::string>& getKeywords() {
+        static std::vector<std::string> keywords(list.begin(), list.end());
         return keywords;
     }
+
+    // The same words, for lookups: one hash and one compare per lexeme
+    static constexpr KeywordTable<list.size()> table{list};
 };
 
 #endif // KEYWORDS_HPP
\ No newline at end of file
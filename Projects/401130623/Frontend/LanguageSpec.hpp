@@ -0,0 +1,114 @@
+#ifndef LANGUAGE_SPEC_HPP
+#define LANGUAGE_SPEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The lexical side of a dialect, read from a spec file instead of being
+// compiled in. One directive per line, words separated by blanks, '#'
+// starts a comment; a directive may appear more than once.
+//
+//     keywords   if else while let
+//     operators  + - == !=
+//     delimiters ( ) ; ,
+//     identifier [A-Za-z] [A-Za-z0-9_]
+//     number     [0-9] [0-9]
+//
+// identifier and number give the class of the first character and of the
+// ones after it; they default to the C-like rules of Scanner.hpp.
+// c.spec is the built-in language written this way.
+struct LanguageSpec
+{
+    using CharClass = std::array<bool, 256>;
+
+    std::vector<std::string> keywords;
+    std::vector<std::string> operators;
+    std::vector<std::string> delimiters;
+    CharClass identifierStart = charClass("[A-Za-z]");
+    CharClass identifierPart = charClass("[A-Za-z0-9_]");
+    CharClass numberStart = charClass("[0-9]");
+    CharClass numberPart = charClass("[0-9]");
+
+    static LanguageSpec load(const std::string& filePath) {
+        std::ifstream file(filePath);
+        if (!file.is_open()) {
+            throw std::runtime_error("could not open the spec " + filePath);
+        }
+        return parse(file, filePath);
+    }
+
+    static LanguageSpec parse(std::istream& in, const std::string& name = "spec") {
+        LanguageSpec spec;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::string directive;
+            if (!(words >> directive)) {
+                continue;
+            }
+            std::vector<std::string> args;
+            for (std::string word; words >> word;) {
+                args.push_back(word);
+            }
+            std::string where = name + ":" + std::to_string(lineNumber) + ": ";
+
+            if (directive == "keywords" || directive == "operators" || directive == "delimiters") {
+                std::vector<std::string>& list = directive == "keywords" ? spec.keywords
+                                               : directive == "operators" ? spec.operators : spec.delimiters;
+                for (const std::string& word : args) {
+                    // A word listed twice keeps its first place, like in OperatorTrie
+                    if (std::find(list.begin(), list.end(), word) == list.end()) {
+                        list.push_back(word);
+                    }
+                }
+            }
+            else if (directive == "identifier" || directive == "number") {
+                if (args.size() != 2) {
+                    throw std::runtime_error(where + directive + " takes two character classes");
+                }
+                CharClass& start = directive == "identifier" ? spec.identifierStart : spec.numberStart;
+                CharClass& part = directive == "identifier" ? spec.identifierPart : spec.numberPart;
+                start = charClass(args[0], where);
+                part = charClass(args[1], where);
+            }
+            else {
+                throw std::runtime_error(where + "unknown directive " + directive);
+            }
+        }
+        return spec;
+    }
+
+    // "[a-z_$]" style classes: single bytes and ranges, nothing else
+    static CharClass charClass(const std::string& text, const std::string& where = "") {
+        if (text.size() < 3 || text.front() != '[' || text.back() != ']') {
+            throw std::runtime_error(where + "bad character class " + text);
+        }
+        CharClass result{};
+        for (size_t i = 1; i + 1 < text.size(); ++i) {
+            unsigned char low = static_cast<unsigned char>(text[i]);
+            unsigned char high = low;
+            if (i + 3 < text.size() && text[i + 1] == '-') {
+                high = static_cast<unsigned char>(text[i + 2]);
+                i += 2;
+            }
+            if (high < low) {
+                throw std::runtime_error(where + "bad range in " + text);
+            }
+            for (unsigned c = low; c <= high; ++c) {
+                result[c] = true;
+            }
+        }
+        return result;
+    }
+};
+
+#endif // LANGUAGE_SPEC_HPP
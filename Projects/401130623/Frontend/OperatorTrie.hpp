@@ -0,0 +1,104 @@
+#ifndef OPERATOR_TRIE_HPP
+#define OPERATOR_TRIE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+// Trie over the operator and delimiter spellings, built by the compiler.
+// match() walks it straight over the source buffer and returns the longest
+// spelling that starts there (maximal munch), so "==" wins over "=" and
+// "++" over "+" without building a string for either. Symbols are ASCII.
+//
+//     static constexpr OperatorTrie<8> trie(Operators::list, Delimiters::list);
+//     trie.match(p, end)  ->  {length, OperatorTrie<8>::OPERATOR}
+//
+// Nodes is an upper bound on the trie size; trieNodes() computes it.
+template <std::size_t Nodes>
+class OperatorTrie
+{
+public:
+    enum Kind : std::uint8_t { NONE, OPERATOR, DELIMITER };
+
+    struct Match {
+        std::size_t length;
+        Kind kind;
+    };
+
+    template <std::size_t O, std::size_t D>
+    constexpr OperatorTrie(const std::array<std::string_view, O>& operators,
+                           const std::array<std::string_view, D>& delimiters) {
+        for (std::string_view symbol : operators) {
+            insert(symbol, OPERATOR);
+        }
+        for (std::string_view symbol : delimiters) {
+            insert(symbol, DELIMITER);
+        }
+    }
+
+    constexpr Match match(const char* p, const char* end) const {
+        Match best{0, NONE};
+        std::size_t node = 0;
+        for (const char* q = p; q < end; ++q) {
+            unsigned char c = static_cast<unsigned char>(*q);
+            if (c >= 128 || (node = next[node][c]) == 0) {
+                break;
+            }
+            if (kind[node] != NONE) {
+                best = {static_cast<std::size_t>(q - p + 1), kind[node]};
+            }
+        }
+        return best;
+    }
+
+    constexpr Match match(std::string_view text) const {
+        return match(text.data(), text.data() + text.size());
+    }
+
+private:
+    // Node 0 is the root, so 0 in next[] also means "no edge"
+    std::array<std::array<std::uint8_t, 128>, Nodes> next{};
+    std::array<Kind, Nodes> kind{};
+    std::size_t used = 1;
+
+    static_assert(Nodes <= 256, "node ids are stored in one byte");
+
+    constexpr void insert(std::string_view symbol, Kind k) {
+        std::size_t node = 0;
+        for (char ch : symbol) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            if (c >= 128) {
+                throw std::logic_error("OperatorTrie: symbols must be ASCII");
+            }
+            if (next[node][c] == 0) {
+                if (used >= Nodes) {
+                    throw std::logic_error("OperatorTrie: Nodes is too small");
+                }
+                next[node][c] = static_cast<std::uint8_t>(used++);
+            }
+            node = next[node][c];
+        }
+        // A spelling listed twice keeps its first kind
+        if (kind[node] == NONE) {
+            kind[node] = k;
+        }
+    }
+};
+
+// Root plus one node per character: enough for any set of spellings
+template <std::size_t O, std::size_t D>
+constexpr std::size_t trieNodes(const std::array<std::string_view, O>& operators,
+                                const std::array<std::string_view, D>& delimiters) {
+    std::size_t nodes = 1;
+    for (std::string_view symbol : operators) {
+        nodes += symbol.size();
+    }
+    for (std::string_view symbol : delimiters) {
+        nodes += symbol.size();
+    }
+    return nodes;
+}
+
+#endif // OPERATOR_TRIE_HPP
@@ -1,20 +1,25 @@
 #ifndef OPERATORS_HPP
 #define OPERATORS_HPP
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Operators
 {
 public:
-    static const std::vector<std::string>& getOperators() {
-        static std::vector<std::string> operators = {
-            "+" , "-" , "*" , "/" , "/" ,
-            "=" , "++" , "--" , "==" , "!=" ,
-            "<=" 
+    // Spellings for OperatorTrie, which is built at compile time
+    static constexpr std::array<std::string_view, 11> list = {
+        "+" , "-" , "*" , "/" , "/" ,
+        "=" , "++" , "--" , "==" , "!=" ,
+        "<="
+    };
 
-        };
-        return operator;
+    // The same list as strings, copied from the array so the two agree
+    static const std::vector<std::string>& getOperators() {
+        static std::vector<std::string> operators(list.begin(), list.end());
+        return operators;
     }
 };
 
@@ -10,21 +10,28 @@
 #include <Delimiters.hpp>
 #include <Keywords.hpp>
 #include <Operators.hpp>
+#include <OperatorTrie.hpp>
 #include <Token.hpp>
 
 class Scanner
 {
 public:
     bool isKeyword(const std::string& word) {
-        return std::find(Keywords::getKeywords().begin, Keywords::getKeywords().end, word) != Keywords
+        return Keywords::table.contains(word);
     }
 
+    // Operators and delimiters in one trie, matched longest first
+    using Symbols = OperatorTrie<trieNodes(Operators::list, Delimiters::list)>;
+    static constexpr Symbols symbols{Operators::list, Delimiters::list};
+
     bool isOperator(const std::string& word) {
-        return std::find(Operators::getOperators().begin, Operators::getOperator().end, word) != Operators
+        Symbols::Match match = symbols.match(word);
+        return match.kind == Symbols::OPERATOR && match.length == word.size();
     }
     
     bool isDelimiter(const std::string& word) {
-        return std::find(Delimiters::getDelimiters().begin, Delimiters::getDelimiter().end, word) != Delimiters
+        Symbols::Match match = symbols.match(word);
+        return match.kind == Symbols::DELIMITER && match.length == word.size();
     }
     std::vector<Token> scan(const std::string& code, int line) {
         std::vector<Token> tokens;
@@ -57,18 +64,12 @@ public:
                     ++i;
                 }
                 std::string number = code.substr(start, i-start);
-                tokens.emplace_back(TokenType::NUMBER, word, line); 
+                tokens.emplace_back(TokenType::NUMBER, number, line); 
             }
-            else if (isOperator(std::string( 1, code[i]))) {
-                size_t start = i;
-                ++i;
-                if (i < code.length() && isOperator( code.substr( start, 2))){
-                    tokens.emplace_back(TokenType::OPERATOR, code.substr( start, 2), line);
-                    ++i; 
-                }
-                else {
-                    tokens.emplace_back(TokenType::OPERATOR, code.substr( start, 1), line);
-                }
+            else if (Symbols::Match match = symbols.match(code.data() + i, code.data() + code.length()); match.length > 0) {
+                TokenType type = match.kind == Symbols::OPERATOR ? TokenType::OPERATOR : TokenType::DELIMITER;
+                tokens.emplace_back(type, code.substr(i, match.length), line);
+                i += match.length;
             }
             else {
                 tokens.emplace_back(TokenType::UNKNOWN, std::string( 1, code[i]), line);
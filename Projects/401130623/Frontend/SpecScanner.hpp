@@ -0,0 +1,168 @@
+#ifndef SPEC_SCANNER_HPP
+#define SPEC_SCANNER_HPP
+
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include <KeywordTable.hpp>
+#include <LanguageSpec.hpp>
+#include <Token.hpp>
+
+// Scanner for a LanguageSpec loaded at runtime, with the same scan()
+// interface and output as Scanner.
+//
+// At construction the operators, delimiters, identifier and number rules
+// are compiled into one DFA over bytes, and the keywords into a
+// DynamicKeywordTable. scan() then walks the DFA once per token, keeping
+// the last accepting state (maximal munch), and looks identifiers up in
+// the table: one table load per byte and one hash per identifier, so the
+// cost per byte does not depend on how many keywords or symbols the
+// spec has. When a symbol and an identifier or number end at the same
+// place the symbol wins; a spelling that is both an operator and a
+// delimiter is an operator.
+class SpecScanner
+{
+public:
+    explicit SpecScanner(LanguageSpec languageSpec)
+        : spec(std::make_shared<const LanguageSpec>(std::move(languageSpec))),
+          keywords(views(spec->keywords)) {
+        compile();
+    }
+
+    static SpecScanner fromFile(const std::string& filePath) {
+        return SpecScanner(LanguageSpec::load(filePath));
+    }
+
+    bool isKeyword(std::string_view word) const {
+        return keywords.contains(word);
+    }
+
+    // DFA size, not counting the dead state
+    std::size_t states() const {
+        return accept.size() - 1;
+    }
+
+    std::vector<Token> scan(const std::string& code, int line) const {
+        std::vector<Token> tokens;
+        const unsigned char* text = reinterpret_cast<const unsigned char*>(code.data());
+        size_t i = 0;
+        while (i < code.length()) {
+            if (std::isspace(text[i])) {
+                ++i;
+                continue;
+            }
+
+            Kind kind = NONE;
+            size_t length = 0;
+            std::uint32_t state = START;
+            for (size_t j = i; j < code.length() && (state = next[state * 256 + text[j]]) != DEAD; ++j) {
+                if (accept[state] != NONE) {
+                    kind = accept[state];
+                    length = j - i + 1;
+                }
+            }
+
+            if (kind == NONE) {
+                tokens.emplace_back(TokenType::UNKNOWN, std::string(1, code[i]), line);
+                ++i;
+                continue;
+            }
+            std::string word = code.substr(i, length);
+            TokenType type = kind == OPERATOR ? TokenType::OPERATOR
+                           : kind == DELIMITER ? TokenType::DELIMITER
+                           : kind == NUMBER ? TokenType::NUMBER
+                           : isKeyword(word) ? TokenType::KEYWORD : TokenType::IDENTIFIER;
+            tokens.emplace_back(type, word, line);
+            i += length;
+        }
+        return tokens;
+    }
+
+private:
+    // What the longest match so far is
+    enum Kind : std::uint8_t { NONE, NUMBER, IDENTIFIER, DELIMITER, OPERATOR };
+
+    static constexpr std::uint32_t DEAD = 0;
+    static constexpr std::uint32_t START = 1;
+
+    // Shared so the keyword table's views stay valid when the scanner is copied
+    std::shared_ptr<const LanguageSpec> spec;
+    DynamicKeywordTable keywords;
+    std::vector<std::uint32_t> next;  // next[state * 256 + byte]
+    std::vector<Kind> accept;
+
+    static std::vector<std::string_view> views(const std::vector<std::string>& words) {
+        return std::vector<std::string_view>(words.begin(), words.end());
+    }
+
+    // Subset construction. The NFA is a trie of the symbol spellings plus
+    // two states each for identifiers and numbers; a DFA state is the
+    // trie node reached (-1 for none) and whether an identifier or a
+    // number is still being read. Trie node 0, the root, only occurs in
+    // the start state.
+    void compile() {
+        std::vector<std::array<int, 256>> trie(1);
+        std::vector<Kind> symbolKind(1, NONE);
+        auto insert = [&](const std::string& symbol, Kind kind) {
+            int node = 0;
+            for (unsigned char c : symbol) {
+                if (trie[node][c] == 0) {
+                    trie[node][c] = static_cast<int>(trie.size());
+                    trie.emplace_back();
+                    symbolKind.push_back(NONE);
+                }
+                node = trie[node][c];
+            }
+            if (symbolKind[node] == NONE) {
+                symbolKind[node] = kind;
+            }
+        };
+        for (const std::string& symbol : spec->operators) {
+            insert(symbol, OPERATOR);
+        }
+        for (const std::string& symbol : spec->delimiters) {
+            insert(symbol, DELIMITER);
+        }
+
+        using Subset = std::tuple<int, bool, bool>;
+        std::map<Subset, std::uint32_t> ids;
+        std::vector<Subset> subsets;
+        auto intern = [&](const Subset& subset) {
+            auto [it, added] = ids.emplace(subset, static_cast<std::uint32_t>(subsets.size() + 1));
+            if (added) {
+                subsets.push_back(subset);
+                auto [node, identifier, number] = subset;
+                Kind kind = node > 0 && symbolKind[node] != NONE ? symbolKind[node]
+                          : identifier ? IDENTIFIER : number ? NUMBER : NONE;
+                accept.push_back(kind);
+            }
+            return it->second;
+        };
+
+        accept.push_back(NONE);  // DEAD
+        intern({0, false, false});
+        for (size_t s = 0; s < subsets.size(); ++s) {
+            auto [node, identifier, number] = subsets[s];
+            bool start = node == 0;
+            next.resize((subsets.size() + 1) * 256, DEAD);
+            for (unsigned c = 0; c < 256; ++c) {
+                int nextNode = node >= 0 && trie[node][c] != 0 ? trie[node][c] : -1;
+                bool nextIdentifier = start ? spec->identifierStart[c] : identifier && spec->identifierPart[c];
+                bool nextNumber = start ? spec->numberStart[c] : number && spec->numberPart[c];
+                if (nextNode >= 0 || nextIdentifier || nextNumber) {
+                    std::uint32_t target = intern({nextNode, nextIdentifier, nextNumber});
+                    next.resize((subsets.size() + 1) * 256, DEAD);
+                    next[(s + 1) * 256 + c] = target;
+                }
+            }
+        }
+    }
+};
+
+#endif // SPEC_SCANNER_HPP
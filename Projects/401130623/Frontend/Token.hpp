@@ -10,14 +10,15 @@ enum class TokenType {
     NUMBER,
     END_OF_FILE,
     UNKNOWN,
+    DELIMITER,
 };
 
-struct token {
+struct Token {
     TokenType type;
     std::string value;
     int line;
 
-    token(TokenType type, const std::string& value,int line)
+    Token(TokenType type, const std::string& value,int line)
         : type(type), value(value), line(line) {}
 };
 
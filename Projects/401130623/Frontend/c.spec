@@ -0,0 +1,10 @@
+# The built-in language of Scanner.hpp (Keywords.hpp, Operators.hpp and
+# Delimiters.hpp) as a spec file for SpecScanner:
+#
+#     ./main --spec Frontend/c.spec Frontend/test.hol
+
+keywords   float int return if else for while do char double string let
+operators  + - * / = ++ -- == != <=
+delimiters ( ) { } [ ] ; , . :
+identifier [A-Za-z] [A-Za-z0-9_]
+number     [0-9] [0-9]
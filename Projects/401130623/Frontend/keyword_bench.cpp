@@ -0,0 +1,131 @@
+// Keyword lookup micro-benchmark: KeywordTable against the lookups used by the
+// other lexers in Projects/, all on the keywords of the README language.
+//
+//     g++ -std=c++17 -O2 -I. keyword_bench.cpp -o keyword_bench && ./keyword_bench [lexemes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <KeywordTable.hpp>
+
+enum Token_Type {
+    PROGRAM, VAR, START, END, PROGRAM_END, PRINT, READ, IF, ITERATION, PUT, IDENTIFIER
+};
+
+static constexpr KeywordTable<10> table{{
+    "Program", "Var", "Start", "End", "end", "Print", "Read", "If", "Iteration", "Put"
+}};
+
+// 401130923/Compiler.cpp
+static const std::set<std::string> keywordSet = {
+    "Program", "Var", "Start", "End", "end", "Print", "Read", "If", "Iteration", "Put"
+};
+
+// 400130163-400130293/src.cpp, and Scanner::isKeyword before KeywordTable
+static const std::vector<std::string> keywordVector = {
+    "Program", "Var", "Start", "End", "end", "Print", "Read", "If", "Iteration", "Put"
+};
+
+// 401130213/compiler_project.cpp
+static std::map<std::string, Token_Type> keywordMap = {
+    {"Program", PROGRAM}, {"Var", VAR}, {"Start", START}, {"End", END}, {"end", PROGRAM_END},
+    {"Print", PRINT}, {"Read", READ}, {"If", IF}, {"Iteration", ITERATION}, {"Put", PUT}
+};
+
+// 400130533/main/main.c
+static Token_Type strcmpChain(const char* value) {
+    if (strcmp(value, "Program") == 0) return PROGRAM;
+    else if (strcmp(value, "Var") == 0) return VAR;
+    else if (strcmp(value, "Start") == 0) return START;
+    else if (strcmp(value, "End") == 0) return END;
+    else if (strcmp(value, "end") == 0) return PROGRAM_END;
+    else if (strcmp(value, "Print") == 0) return PRINT;
+    else if (strcmp(value, "Read") == 0) return READ;
+    else if (strcmp(value, "If") == 0) return IF;
+    else if (strcmp(value, "Iteration") == 0) return ITERATION;
+    else if (strcmp(value, "Put") == 0) return PUT;
+    return IDENTIFIER;
+}
+
+static Token_Type perfectHash(const std::string& word) {
+    int index = table.find(word);
+    return index < 0 ? IDENTIFIER : static_cast<Token_Type>(index);
+}
+
+// Only answers keyword or not, like the lexer it comes from
+static int treeSet(const std::string& word) {
+    return keywordSet.find(word) != keywordSet.end();
+}
+
+static Token_Type linearFind(const std::string& word) {
+    auto it = std::find(keywordVector.begin(), keywordVector.end(), word);
+    return it == keywordVector.end() ? IDENTIFIER : static_cast<Token_Type>(it - keywordVector.begin());
+}
+
+static Token_Type treeMap(const std::string& word) {
+    if (keywordMap.find(word) != keywordMap.end()) {
+        return keywordMap[word];
+    }
+    return IDENTIFIER;
+}
+
+// Words of typical programs: keywords, short and long names, near misses
+static std::vector<std::string> makeLexemes(std::size_t count) {
+    static const char* words[] = {
+        "Put", "x", "Print", "counter", "Read", "If", "y", "End", "Start", "Iteration",
+        "total", "i", "Var", "sum", "Prog", "Ends", "n", "Program", "end", "value",
+        "Reader", "temp", "Put", "x", "If", "End", "Starts", "result", "z", "Printer"
+    };
+    std::vector<std::string> lexemes;
+    unsigned seed = 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        lexemes.push_back(words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))]);
+    }
+    return lexemes;
+}
+
+template <typename Lookup>
+static void run(const char* name, const std::vector<std::string>& lexemes, Lookup lookup, long long expected) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e30;
+    long long checksum = 0;
+    for (int round = 0; round < 5; ++round) {
+        checksum = 0;
+        auto start = Clock::now();
+        for (const std::string& lexeme : lexemes) {
+            checksum += lookup(lexeme);
+        }
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << best / lexemes.size() << " ns/lexeme"
+              << (checksum != expected ? "  MISMATCH" : "") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::vector<std::string> lexemes = makeLexemes(count);
+
+    long long expected = 0, keywords = 0;
+    for (const std::string& lexeme : lexemes) {
+        expected += perfectHash(lexeme);
+        keywords += table.contains(lexeme);
+    }
+    std::cout << count << " lexemes\n";
+    run("KeywordTable (perfect hash)", lexemes, perfectHash, expected);
+    run("set<string> (401130923)", lexemes, treeSet, keywords);
+    run("vector find (400130163, Scanner)", lexemes, linearFind, expected);
+    run("map<string, Token_Type> (401130213)", lexemes, treeMap, expected);
+    run("strcmp chain (400130533)", lexemes, [](const std::string& word) {
+        return strcmpChain(word.c_str());
+    }, expected);
+    return 0;
+}
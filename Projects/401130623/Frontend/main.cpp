@@ -1,22 +1,31 @@
 #include <iostream>
 #include <fstream>
+#include <deque>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <iomanip>
 #include "Frontend/Scanner.hpp"
+#include "Frontend/SpecScanner.hpp"
+#include "Frontend/ThreadPool.hpp"
 
-void scanFile(const std::string& filePath){
-    std::ifstram file(filePath);
+template <typename ScannerType = Scanner>
+void scanFile(const std::string& filePath, std::ostream& out = std::cout, ScannerType scanner = ScannerType()){
+    std::ifstream file(filePath);
     if (!file.is_open()) {
         std::cerr << "Error: could not open the file " << filePath <<std::endl;
         return;
     }
 
-    Scanner scanner;
     std::string line;
     int lineNumber = 1;
 
     while (std::getline( file, line)) {
         std::vector<Token> tokens = scanner.scan(line, lineNumber);
         for (const auto& token : tokens) {
-            std::cout << "Token: " << token.value << ", Type: "
+            out << "Token: " << token.value << ", Type: "
                     <<static_cast<int>(token.type) << ", line: " << token.line << std::endl;
         }
         lineNumber++;
@@ -24,12 +33,172 @@ void scanFile(const std::string& filePath){
     file.close();
 }
 
+// Scans the whole lines in text, numbering them from firstLine, and formats
+// the tokens exactly like scanFile does
+std::string scanLines(const std::string& text, int firstLine) {
+    Scanner scanner;
+    std::string out;
+    std::string line;
+    int lineNumber = firstLine;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        line.assign(text, start, end - start);
+        for (const auto& token : scanner.scan(line, lineNumber)) {
+            out += "Token: ";
+            out += token.value;
+            out += ", Type: ";
+            out += std::to_string(static_cast<int>(token.type));
+            out += ", line: ";
+            out += std::to_string(token.line);
+            out += '\n';
+        }
+        lineNumber++;
+        start = end + 1;
+    }
+    return out;
+}
+
+// Same output as scanFile, but the file is read in large blocks, each block
+// (cut after its last newline) is scanned on the pool, and the results are
+// written back in block order. At most a few blocks per thread are in flight.
+void scanFileParallel(const std::string& filePath, unsigned threads, std::ostream& out = std::cout,
+                      size_t blockSize = 4 << 20){
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: could not open the file " << filePath <<std::endl;
+        return;
+    }
+
+    ThreadPool pool(threads);
+    std::deque<std::future<std::string>> pending;
+    std::string carry;
+    std::vector<char> block(blockSize);
+    int nextLine = 1;
+
+    auto submit = [&](std::string text) {
+        int firstLine = nextLine;
+        for (size_t at = text.find('\n'); at != std::string::npos; at = text.find('\n', at + 1)) {
+            nextLine++;
+        }
+        pending.push_back(pool.submit([text = std::move(text), firstLine] {
+            return scanLines(text, firstLine);
+        }));
+        while (pending.size() > 2 * threads + 2) {
+            std::string result = pending.front().get();
+            out.write(result.data(), result.size());
+            pending.pop_front();
+        }
+    };
+
+    while (file.read(block.data(), block.size()) || file.gcount() > 0) {
+        const char* data = block.data();
+        size_t size = static_cast<size_t>(file.gcount());
+        size_t lastNewline = std::string_view(data, size).rfind('\n');
+        if (lastNewline == std::string_view::npos) {
+            carry.append(data, size);
+            continue;
+        }
+        // Whole lines go out now, the unfinished last one waits for the next block
+        std::string text = std::move(carry);
+        text.append(data, lastNewline + 1);
+        carry.assign(data + lastNewline + 1, data + size);
+        submit(std::move(text));
+    }
+    if (!carry.empty()) {
+        submit(std::move(carry));
+    }
+    for (auto& result : pending) {
+        std::string text = result.get();
+        out.write(text.data(), text.size());
+    }
+}
+
+// Swallows output, counting it, so the benchmark measures scanning and not the terminal
+class CountingBuffer : public std::streambuf
+{
+public:
+    size_t count = 0;
+
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        count += n;
+        return n;
+    }
+
+    int overflow(int c) override {
+        count++;
+        return c;
+    }
+};
+
+void benchmark(size_t megabytes, unsigned maxThreads) {
+    std::string filePath = "scan_bench.txt";
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        std::string lines;
+        for (int i = 0; i < 1000; ++i) {
+            lines += "let x" + std::to_string(i) + " = (a + b) * c - " + std::to_string(i) + ";\n";
+            lines += "if (x != 10) { y++; return x <= y; }\n";
+            lines += "    float total = total / 2.5; // running mean\n";
+        }
+        for (size_t written = 0; written < megabytes << 20; written += lines.size()) {
+            file << lines;
+        }
+    }
+    std::cout << megabytes << " MB input, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    auto time = [&](auto run) {
+        CountingBuffer buffer;
+        std::ostream out(&buffer);
+        auto start = std::chrono::steady_clock::now();
+        run(out);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(seconds, buffer.count);
+    };
+
+    auto [baseSeconds, baseBytes] = time([&](std::ostream& out) { scanFile(filePath, out); });
+    std::cout << std::fixed << std::setprecision(1) << "getline, one line at a time  "
+              << megabytes / baseSeconds << " MB/s\n";
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        auto [seconds, bytes] = time([&](std::ostream& out) { scanFileParallel(filePath, threads, out); });
+        std::cout << "blocks, " << std::setw(2) << threads << " threads            " << megabytes / seconds
+                  << " MB/s  x" << std::setprecision(2) << baseSeconds / seconds << std::setprecision(1)
+                  << (bytes == baseBytes ? "" : "  OUTPUT DIFFERS") << "\n";
+    }
+    std::remove(filePath.c_str());
+}
+
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        benchmark(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024,
+                  argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8);
+        return 0;
+    }
+    if (argc == 4 && std::string(argv[1]) == "--threads") {
+        scanFileParallel(argv[3], std::max(1ul, std::strtoul(argv[2], nullptr, 10)));
+        return 0;
+    }
+    if (argc == 4 && std::string(argv[1]) == "--spec") {
+        try {
+            scanFile(argv[3], std::cout, SpecScanner::fromFile(argv[2]));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
     if (argc !=2) {
-        std::cerr << "Usage: " << argv[0] << " <input_file>" <<std::endl;
+        std::cerr << "Usage: " << argv[0] << " [--threads <n>] <input_file>" <<std::endl;
+        std::cerr << "       " << argv[0] << " --spec <language.spec> <input_file>" <<std::endl;
+        std::cerr << "       " << argv[0] << " --bench [megabytes] [max_threads]" <<std::endl;
         return 1;
     }
-    std::string filePath = arg[1];
+    std::string filePath = argv[1];
     scanFile(filePath);
 
     return 0;
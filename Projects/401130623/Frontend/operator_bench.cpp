@@ -0,0 +1,106 @@
+// Operator scanning benchmark: Scanner::scan with the OperatorTrie against the
+// probe-by-substring loop it replaced, on operator-dense lines.
+//
+//     g++ -std=c++17 -O2 -I. operator_bench.cpp -o operator_bench && ./operator_bench [lines]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <Scanner.hpp>
+
+// Scanner::scan as it was: every operator probe builds a string and runs
+// std::find over Operators::getOperators()
+class LegacyScanner : public Scanner
+{
+public:
+    bool isOperator(const std::string& word) {
+        const std::vector<std::string>& operators = Operators::getOperators();
+        return std::find(operators.begin(), operators.end(), word) != operators.end();
+    }
+
+    std::vector<Token> scan(const std::string& code, int line) {
+        std::vector<Token> tokens;
+        size_t i = 0;
+        while (i < code.length()) {
+            if (std::isspace(code[i])) {
+                ++i;
+                continue;
+            }
+            if (std::isalpha(code[i])) {
+                size_t start = i;
+                while (i < code.length() && (std::isalnum(code[i]) || code[i] == '_')) {
+                    ++i;
+                }
+                std::string word = code.substr(start, i - start);
+                tokens.emplace_back(isKeyword(word) ? TokenType::KEYWORD : TokenType::IDENTIFIER, word, line);
+            }
+            else if (std::isdigit(code[i])) {
+                size_t start = i;
+                while (i < code.length() && std::isdigit(code[i])) {
+                    ++i;
+                }
+                tokens.emplace_back(TokenType::NUMBER, code.substr(start, i - start), line);
+            }
+            else if (isOperator(std::string(1, code[i]))) {
+                size_t start = i;
+                ++i;
+                if (i < code.length() && isOperator(code.substr(start, 2))) {
+                    tokens.emplace_back(TokenType::OPERATOR, code.substr(start, 2), line);
+                    ++i;
+                }
+                else {
+                    tokens.emplace_back(TokenType::OPERATOR, code.substr(start, 1), line);
+                }
+            }
+            else {
+                tokens.emplace_back(TokenType::UNKNOWN, std::string(1, code[i]), line);
+                ++i;
+            }
+        }
+        return tokens;
+    }
+};
+
+template <typename ScannerType>
+static void run(const char* name, const std::vector<std::string>& lines, size_t bytes) {
+    using Clock = std::chrono::steady_clock;
+    ScannerType scanner;
+    double best = 1e30;
+    size_t count = 0;
+    for (int round = 0; round < 5; ++round) {
+        count = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < lines.size(); ++i) {
+            count += scanner.scan(lines[i], static_cast<int>(i + 1)).size();
+        }
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << count << " tokens" << std::setw(9) << bytes / best / 1e6 << " MB/s"
+              << std::setw(9) << best * 1e9 / count << " ns/token\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    static const char* samples[] = {
+        "x = a+b-c*d/e;",
+        "i++; j--; k = i == j;",
+        "if (a != b) { c = a <= b; }",
+        "x=x+1;y=y-1;z=x*y/2;",
+        "arr[i] = arr[i+1] - arr[i-1];",
+        "n = -m + +k -- - ++j;",
+    };
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(samples[i % (sizeof(samples) / sizeof(samples[0]))]);
+        bytes += lines.back().size();
+    }
+    std::cout << count << " lines, " << bytes << " bytes\n";
+    run<LegacyScanner>("std::find per probe", lines, bytes);
+    run<Scanner>("OperatorTrie", lines, bytes);
+    return 0;
+}
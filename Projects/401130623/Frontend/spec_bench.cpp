@@ -0,0 +1,83 @@
+// Language spec benchmark: SpecScanner with a 10-keyword and a 1,000-keyword
+// spec over the same input, next to the built-in Scanner. Both specs share
+// the operators and delimiters of c.spec and the first ten keywords.
+//
+//     g++ -std=c++17 -O2 -I. spec_bench.cpp -o spec_bench && ./spec_bench [lines]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <Scanner.hpp>
+#include <SpecScanner.hpp>
+
+static std::string specText(size_t keywordCount) {
+    std::string text = "keywords float int return if else for while do char double\n"
+                       "operators + - * / = ++ -- == != <=\n"
+                       "delimiters ( ) { } [ ] ; , . :\n";
+    // The rest are made-up lowercase words of 3 to 9 letters
+    std::mt19937 random(42);
+    for (size_t i = 10; i < keywordCount; ++i) {
+        std::string word;
+        for (size_t length = 3 + random() % 7; word.size() < length;) {
+            word += static_cast<char>('a' + random() % 26);
+        }
+        text += "keywords " + word + "\n";
+    }
+    return text;
+}
+
+template <typename ScannerType>
+static void run(const std::string& name, const ScannerType& prototype, const std::vector<std::string>& lines,
+                size_t bytes) {
+    using Clock = std::chrono::steady_clock;
+    ScannerType scanner = prototype;
+    double best = 1e30;
+    size_t count = 0;
+    for (int round = 0; round < 5; ++round) {
+        count = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < lines.size(); ++i) {
+            count += scanner.scan(lines[i], static_cast<int>(i + 1)).size();
+        }
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << count << " tokens" << std::setw(9) << bytes / best / 1e6 << " MB/s"
+              << std::setw(9) << best * 1e9 / count << " ns/token\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    static const char* samples[] = {
+        "int total = 0;",
+        "for (i = 0; i <= count; i++) { total = total + values[i]; }",
+        "if (total != limit) { return total / 2; }",
+        "double mean = sum / n2; char c = buffer[k3];",
+        "while (node != end) { node = node.next; depth++; }",
+        "float x1 = a*b - c*d; do { x1--; } while (x1);",
+    };
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(samples[i % (sizeof(samples) / sizeof(samples[0]))]);
+        bytes += lines.back().size();
+    }
+    std::cout << count << " lines, " << bytes << " bytes\n";
+
+    run("Scanner (built in)", Scanner(), lines, bytes);
+    for (size_t keywords : {10, 1000}) {
+        auto start = std::chrono::steady_clock::now();
+        std::istringstream text(specText(keywords));
+        SpecScanner scanner(LanguageSpec::parse(text));
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "spec with " << keywords << " keywords: " << scanner.states() << " DFA states, loaded in "
+                  << std::setprecision(0) << micros << " us\n";
+        run("SpecScanner, " + std::to_string(keywords) + " keywords", scanner, lines, bytes);
+    }
+    return 0;
+}
@@ -4,6 +4,13 @@
 #include <cctype>
 #include <string>
 #include <set>
+#include <cstdio>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
 
 using namespace std;
 
@@ -35,8 +42,196 @@ void initializeKeywords() {
     keywords.insert("Put");
 }
 
+// Reads a file in large aligned blocks into two buffers. The lexer works on
+// the byte window [cur, end) of one buffer; refill() hands it the other one.
+// With readAhead a background thread fills the idle buffer meanwhile.
+class BlockReader {
+public:
+    const char* cur = nullptr;
+    const char* end = nullptr;
+
+    BlockReader(const string& filename, bool readAhead = true, size_t blockSize = 1 << 20)
+        : blockSize(blockSize), readAhead(readAhead) {
+        file = fopen(filename.c_str(), "rb");
+        if (!file) {
+            return;
+        }
+        // The blocks are our buffer, stdio does not need one of its own
+        setvbuf(file, NULL, _IONBF, 0);
+        for (int i = 0; i < 2; i++) {
+            buffers[i] = static_cast<char*>(::operator new(blockSize, align_val_t(4096)));
+            filled[i] = false;
+        }
+        if (readAhead) {
+            worker = thread(&BlockReader::readLoop, this);
+        }
+    }
+
+    ~BlockReader() {
+        if (readAhead && worker.joinable()) {
+            {
+                lock_guard<mutex> lock(guard);
+                stopping = true;
+            }
+            changed.notify_all();
+            worker.join();
+        }
+        for (int i = 0; i < 2; i++) {
+            if (buffers[i]) {
+                ::operator delete(buffers[i], align_val_t(4096));
+            }
+        }
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    bool isOpen() const {
+        return file != NULL;
+    }
+
+    // Moves the window to the next block, false at end of file
+    bool refill() {
+        if (!file || atEnd) {
+            return false;
+        }
+        int next = current < 0 ? 0 : 1 - current;
+        if (readAhead) {
+            unique_lock<mutex> lock(guard);
+            if (current >= 0) {
+                // The lexer is done with the old window, the reader may reuse it
+                filled[current] = false;
+                changed.notify_all();
+            }
+            changed.wait(lock, [&] { return filled[next]; });
+        } else {
+            sizes[next] = fread(buffers[next], 1, blockSize, file);
+        }
+        current = next;
+        cur = buffers[next];
+        end = cur + sizes[next];
+        atEnd = sizes[next] == 0;
+        return !atEnd;
+    }
+
+private:
+    FILE* file = NULL;
+    size_t blockSize;
+    bool readAhead;
+    char* buffers[2] = {NULL, NULL};
+    size_t sizes[2] = {0, 0};
+    bool filled[2];
+    int current = -1;
+    bool atEnd = false;
+    bool stopping = false;
+    thread worker;
+    mutex guard;
+    condition_variable changed;
+
+    void readLoop() {
+        for (int next = 0; ; next = 1 - next) {
+            {
+                unique_lock<mutex> lock(guard);
+                changed.wait(lock, [&] { return !filled[next] || stopping; });
+                if (stopping) {
+                    return;
+                }
+            }
+            // Only this thread touches an unfilled buffer, so read unlocked
+            size_t count = fread(buffers[next], 1, blockSize, file);
+            {
+                lock_guard<mutex> lock(guard);
+                sizes[next] = count;
+                filled[next] = true;
+            }
+            changed.notify_all();
+            if (count == 0) {
+                return;
+            }
+        }
+    }
+};
+
 // Function to tokenize the input
-vector<Token> tokenize(const string& filename) {
+vector<Token> tokenize(const string& filename, bool readAhead = true) {
+    BlockReader reader(filename, readAhead);
+    vector<Token> tokens;
+    string word;
+    int line = 1;
+
+    if (!reader.isOpen()) {
+        cout << "Error opening file!" << endl;
+        return tokens;
+    }
+
+    // A name or number can run past the end of a block, then the rest of it
+    // comes from the next one
+    TokenType pending = ERROR;
+    while (reader.cur < reader.end || reader.refill()) {
+        const char* p = reader.cur;
+        const char* end = reader.end;
+
+        if (pending != ERROR) {
+            const char* start = p;
+            if (pending == INTEGER) {
+                while (p < end && isdigit((unsigned char)*p)) p++;
+            } else {
+                while (p < end && isalnum((unsigned char)*p)) p++;
+            }
+            word.append(start, p);
+            reader.cur = p;
+            if (p == end) {
+                continue;
+            }
+            TokenType type = pending == INTEGER ? INTEGER : (keywords.find(word) != keywords.end() ? KEYWORD : IDENTIFIER);
+            Token t; t.type = type; t.value = word; t.line = line; tokens.push_back(t);
+            pending = ERROR;
+        }
+
+        while (p < end) {
+            char ch = *p;
+            if (ch == '\n') {
+                line++;
+                p++;
+            } else if (isspace((unsigned char)ch)) {
+                p++;
+            } else if (isalpha((unsigned char)ch) || isdigit((unsigned char)ch)) {
+                bool number = !isalpha((unsigned char)ch);
+                const char* start = p++;
+                if (number) {
+                    while (p < end && isdigit((unsigned char)*p)) p++;
+                } else {
+                    while (p < end && isalnum((unsigned char)*p)) p++;
+                }
+                word.assign(start, p);
+                if (p == end) {
+                    pending = number ? INTEGER : IDENTIFIER;
+                    break;
+                }
+                TokenType type = number ? INTEGER : (keywords.find(word) != keywords.end() ? KEYWORD : IDENTIFIER);
+                Token t; t.type = type; t.value = word; t.line = line; tokens.push_back(t);
+            } else if (ch == '<' || ch == '>' || ch == '=' || ch == '+') {
+                Token t; t.type = OPERATOR; t.value = string(1, ch); t.line = line; tokens.push_back(t);
+                p++;
+            } else if (ch == '(' || ch == ')' || ch == '{' || ch == '}' || ch == ';' || ch == ',') {
+                Token t; t.type = SYMBOL; t.value = string(1, ch); t.line = line; tokens.push_back(t);
+                p++;
+            } else {
+                cout << "Error: invalid character at line " << line << endl;
+                p++;
+            }
+        }
+        reader.cur = p;
+    }
+    if (pending != ERROR) {
+        TokenType type = pending == INTEGER ? INTEGER : (keywords.find(word) != keywords.end() ? KEYWORD : IDENTIFIER);
+        Token t; t.type = type; t.value = word; t.line = line; tokens.push_back(t);
+    }
+    return tokens;
+}
+
+// The original character-at-a-time tokenizer, kept to compare against in --bench
+vector<Token> tokenizeStream(const string& filename) {
     ifstream file(filename.c_str()); // Fix: Use c_str() to convert string to const char*
     vector<Token> tokens;
     string word;
@@ -88,14 +283,20 @@ bool parseProgram(vector<Token>& tokens, size_t& index);
 bool parseBlock(vector<Token>& tokens, size_t& index);
 bool parseStates(vector<Token>& tokens, size_t& index);
 
+// Bounds-checked lookahead: past the last token everything reads as an empty ERROR token
+const Token& peek(const vector<Token>& tokens, size_t index) {
+    static const Token none = {ERROR, "", 0};
+    return index < tokens.size() ? tokens[index] : none;
+}
+
 bool parseProgram(vector<Token>& tokens, size_t& index) {
-    if (tokens[index].value == "Program") {
+    if (peek(tokens, index).value == "Program") {
         index++;
-        if (tokens[index].value == "Var") {
+        if (peek(tokens, index).value == "Var") {
             index++;
-            if (tokens[index].type == IDENTIFIER) {
+            if (peek(tokens, index).type == IDENTIFIER) {
                 index++;
-                if (tokens[index].value == ";") {
+                if (peek(tokens, index).value == ";") {
                     index++;
                     return parseBlock(tokens, index);
                 }
@@ -106,103 +307,236 @@ bool parseProgram(vector<Token>& tokens, size_t& index) {
 }
 
 bool parseBlock(vector<Token>& tokens, size_t& index) {
-    if (tokens[index].value == "Start") {
+    if (peek(tokens, index).value == "Start") {
         index++;
         return parseStates(tokens, index);
     }
     return false;
 }
 
+// Statements up to the closing End. The body of an If or Iteration is parsed
+// as a nested statement list; instead of recursing, its opening token goes on
+// a heap stack, so nesting depth is limited by memory and not by the C++ stack.
+// A nested list ends like the outer one does (End, or a token that starts no
+// statement, normally its '}'); its result is not used and the parent then
+// takes the '}' if it is there.
 bool parseStates(vector<Token>& tokens, size_t& index) {
-    while (index < tokens.size()) {
-        if (tokens[index].value == "End") {
+    vector<size_t> open;
+    while (true) {
+        bool done = false;
+        bool result = false;
+        const Token& token = peek(tokens, index);
+        if (index >= tokens.size()) {
+            done = true;
+        } else if (token.value == "End") {
             index++;
-            return true;
-        } else if (tokens[index].value == "Print") {
+            result = true;
+            done = true;
+        } else if (token.value == "Print") {
             index++;
-            if (tokens[index].value == "(") {
+            if (peek(tokens, index).value == "(") {
                 index++;
-                if (tokens[index].type == IDENTIFIER || tokens[index].type == INTEGER) {
+                if (peek(tokens, index).type == IDENTIFIER || peek(tokens, index).type == INTEGER) {
                     index++;
-                    if (tokens[index].value == ")") {
+                    if (peek(tokens, index).value == ")") {
                         index++;
-                        if (tokens[index].value == ";") {
+                        if (peek(tokens, index).value == ";") {
                             index++;
                         } else {
-                            return false;
+                            done = true;
                         }
                     } else {
-                        return false;
+                        done = true;
                     }
                 }
             }
-        } else if (tokens[index].value == "Read") {
+        } else if (token.value == "Read") {
             index++;
-            if (tokens[index].value == "(") {
+            if (peek(tokens, index).value == "(") {
                 index++;
-                if (tokens[index].type == IDENTIFIER) {
+                if (peek(tokens, index).type == IDENTIFIER) {
                     index++;
-                    if (tokens[index].value == ")") {
+                    if (peek(tokens, index).value == ")") {
                         index++;
-                        if (tokens[index].value == ";") {
+                        if (peek(tokens, index).value == ";") {
                             index++;
                         } else {
-                            return false;
+                            done = true;
                         }
                     } else {
-                        return false;
+                        done = true;
                     }
                 }
             }
-        } else if (tokens[index].value == "If" || tokens[index].value == "Iteration") {
+        } else if (token.value == "If" || token.value == "Iteration") {
+            size_t opener = index;
             index++;
-            if (tokens[index].value == "(") {
+            if (peek(tokens, index).value == "(") {
                 index++;
-                if (tokens[index].type == IDENTIFIER || tokens[index].type == INTEGER) {
+                if (peek(tokens, index).type == IDENTIFIER || peek(tokens, index).type == INTEGER) {
                     index++;
-                    if (tokens[index].value == "<" || tokens[index].value == ">" || tokens[index].value == "==") {
+                    const string& op = peek(tokens, index).value;
+                    if (op == "<" || op == ">" || op == "==") {
                         index++;
-                        if (tokens[index].type == IDENTIFIER || tokens[index].type == INTEGER) {
+                        if (peek(tokens, index).type == IDENTIFIER || peek(tokens, index).type == INTEGER) {
                             index++;
-                            if (tokens[index].value == ")") {
+                            if (peek(tokens, index).value == ")") {
                                 index++;
-                                if (tokens[index].value == "{") {
+                                if (peek(tokens, index).value == "{") {
                                     index++;
-                                    parseStates(tokens, index);
-                                    if (tokens[index].value == "}") {
-                                        index++;
-                                    }
+                                    open.push_back(opener);
                                 }
                             }
                         }
                     }
                 }
             }
-        } else if (tokens[index].value == "Put") {
+        } else if (token.value == "Put") {
             index++;
-            if (tokens[index].type == IDENTIFIER) {
+            if (peek(tokens, index).type == IDENTIFIER) {
                 index++;
-                if (tokens[index].value == "=") {
+                if (peek(tokens, index).value == "=") {
                     index++;
-                    if (tokens[index].type == IDENTIFIER || tokens[index].type == INTEGER) {
+                    if (peek(tokens, index).type == IDENTIFIER || peek(tokens, index).type == INTEGER) {
                         index++;
-                        if (tokens[index].value == ";") {
+                        if (peek(tokens, index).value == ";") {
                             index++;
                         }
                     }
                 }
             }
         } else {
-            return false;
+            done = true;
+        }
+
+        if (done) {
+            if (open.empty()) {
+                return result;
+            }
+            // Back in the enclosing If/Iteration
+            open.pop_back();
+            if (peek(tokens, index).value == "}") {
+                index++;
+            }
         }
     }
-    return false;
+}
+
+// Parses Program ... Start, `depth` nested If bodies around one Print, then the
+// closing braces and End
+void benchmarkNesting(size_t depth) {
+    vector<Token> tokens;
+    auto add = [&](TokenType type, const char* value) {
+        Token t; t.type = type; t.value = value; t.line = 1; tokens.push_back(t);
+    };
+    add(KEYWORD, "Program"); add(KEYWORD, "Var"); add(IDENTIFIER, "x"); add(SYMBOL, ";"); add(KEYWORD, "Start");
+    for (size_t i = 0; i < depth; i++) {
+        add(KEYWORD, i % 2 ? "Iteration" : "If"); add(SYMBOL, "("); add(IDENTIFIER, "x"); add(OPERATOR, "<");
+        add(INTEGER, "10"); add(SYMBOL, ")"); add(SYMBOL, "{");
+    }
+    add(KEYWORD, "Print"); add(SYMBOL, "("); add(IDENTIFIER, "x"); add(SYMBOL, ")"); add(SYMBOL, ";");
+    for (size_t i = 0; i < depth; i++) {
+        add(SYMBOL, "}");
+    }
+    add(KEYWORD, "End");
+
+    size_t index = 0;
+    auto start = chrono::steady_clock::now();
+    bool parsed = parseProgram(tokens, index);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "depth " << depth << ": " << tokens.size() << " tokens, " << (parsed && index == tokens.size() ? "parsed" : "REJECTED")
+         << " in " << seconds * 1000 << " ms, " << tokens.size() / seconds / 1e6 << " M tokens/s" << endl;
+}
+
+// Writes a large program and reports how fast each tokenizer gets through it
+void benchmarkTokenize(int megabytes) {
+    string filename = "bench_input.txt";
+    {
+        ofstream out(filename.c_str());
+        out << "Program Var x; Start\n";
+        string body =
+            "    Read(x);\n"
+            "    Put total = total + 12345;\n"
+            "    If (counter < 100) { Print(counter); }\n"
+            "    Iteration (x > 0) { Put x = x + 1; }\n";
+        for (size_t written = 0; written < (size_t)megabytes << 20; written += body.size()) {
+            out << body;
+        }
+        out << "End\n";
+    }
+
+    struct Path {
+        const char* name;
+        vector<Token> (*run)(const string&);
+    };
+    Path paths[] = {
+        {"ifstream get/unget", [](const string& f) { return tokenizeStream(f); }},
+        {"block reader", [](const string& f) { return tokenize(f, false); }},
+        {"block reader + read-ahead", [](const string& f) { return tokenize(f, true); }},
+    };
+    vector<Token> expected;
+    for (const Path& path : paths) {
+        double best = 1e30;
+        vector<Token> tokens;
+        for (int round = 0; round < 3; round++) {
+            auto start = chrono::steady_clock::now();
+            tokens = path.run(filename);
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        bool same = true;
+        if (expected.empty()) {
+            expected = tokens;
+        } else {
+            same = tokens.size() == expected.size();
+            for (size_t i = 0; same && i < tokens.size(); i++) {
+                same = tokens[i].type == expected[i].type && tokens[i].value == expected[i].value && tokens[i].line == expected[i].line;
+            }
+        }
+        cout << path.name << ": " << tokens.size() << " tokens, " << megabytes / best << " MB/s"
+             << (same ? "" : " (TOKENS DIFFER)") << endl;
+    }
+
+    // The reading alone, without building tokens: count the lines
+    for (int mode = 0; mode < 3; mode++) {
+        double best = 1e30;
+        long long lines = 0;
+        for (int round = 0; round < 3; round++) {
+            auto start = chrono::steady_clock::now();
+            lines = 0;
+            if (mode == 0) {
+                ifstream file(filename.c_str());
+                char ch;
+                while (file.get(ch)) {
+                    lines += ch == '\n';
+                }
+            } else {
+                BlockReader reader(filename, mode == 2);
+                while (reader.cur < reader.end || reader.refill()) {
+                    for (const char* p = reader.cur; p < reader.end; p++) {
+                        lines += *p == '\n';
+                    }
+                    reader.cur = reader.end;
+                }
+            }
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        cout << paths[mode].name << ", reading only: " << lines << " lines, " << megabytes / best << " MB/s" << endl;
+    }
+    remove(filename.c_str());
 }
 
 // Main function
-int main() {
+int main(int argc, char* argv[]) {
     initializeKeywords();
-    string filename = "input.txt";
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkTokenize(argc > 2 ? atoi(argv[2]) : 64);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-nesting") {
+        benchmarkNesting(argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000);
+        return 0;
+    }
+    string filename = argc > 1 ? argv[1] : "input.txt";
     vector<Token> tokens = tokenize(filename);
 
     size_t index = 0;
@@ -1,26 +1,173 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <vector>
+#include <string>
+#include <cctype>
+#include <unordered_set>
+#include <unordered_map>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <functional>
+#include <charconv>
+#include <cstring>
+#include <sys/mman.h>
 using namespace std;
 
+// ---------------------------------------------------------------------------
+// Three-address intermediate representation
+// ---------------------------------------------------------------------------
+
+// Operands are kept as text, as before: an integer literal or a name
+// (a declared variable or a compiler temporary t0, t1, ...).
+bool isConstant(const string& s) {
+    if (s.empty()) return false;
+    if (s[0] == '-') return s.size() > 1 && isdigit(s[1]);
+    return isdigit(s[0]);
+}
+
+// Arithmetic wraps around like the 64-bit registers it will end up in
+long long wrapAdd(long long a, long long b) { return (long long)((unsigned long long)a + (unsigned long long)b); }
+long long wrapSub(long long a, long long b) { return (long long)((unsigned long long)a - (unsigned long long)b); }
+long long wrapMul(long long a, long long b) { return (long long)((unsigned long long)a * (unsigned long long)b); }
+// Division by zero yields 0 rather than trapping; only constant divisors are ever emitted
+long long wrapDiv(long long a, long long b) {
+    if (b == 0) return 0;
+    if (b == -1) return wrapSub(0, a);
+    return a / b;
+}
+
+enum class IROp {
+    Label,   // label:
+    Assign,  // dst = a
+    Add,     // dst = a + b
+    Sub,     // dst = a - b
+    Mul,     // dst = a * b (introduced by optimizations only)
+    Div,     // dst = a / b (introduced by optimizations only)
+    Goto,    // goto label
+    IfFalse, // ifFalse a relop b goto label
+    Read,    // read dst
+    Print    // print a
+};
+
+struct Instr {
+    IROp op = IROp::Assign;
+    string dst{}, a{}, b{};
+    string relop{};  // "<", ">" or "==" for IfFalse
+    string label{};  // label name for Label, jump target for Goto/IfFalse
+
+    // Variable written by this instruction, or "" if none
+    const string& def() const {
+        static const string none;
+        return (op == IROp::Assign || isArithmetic() || op == IROp::Read) ? dst : none;
+    }
+
+    // Variables read by this instruction
+    vector<string> uses() const {
+        vector<string> u;
+        auto add = [&](const string& s) { if (!s.empty() && !isConstant(s)) u.push_back(s); };
+        switch (op) {
+            case IROp::Assign: case IROp::Print: add(a); break;
+            case IROp::Add: case IROp::Sub: case IROp::Mul: case IROp::Div: case IROp::IfFalse:
+                add(a); add(b); break;
+            default: break;
+        }
+        return u;
+    }
+
+    bool isJump() const { return op == IROp::Goto || op == IROp::IfFalse; }
+    bool isArithmetic() const { return op == IROp::Add || op == IROp::Sub || op == IROp::Mul || op == IROp::Div; }
+
+    string toString() const {
+        switch (op) {
+            case IROp::Label:   return label + ":";
+            case IROp::Assign:  return "  " + dst + " = " + a;
+            case IROp::Add:     return "  " + dst + " = " + a + " + " + b;
+            case IROp::Sub:     return "  " + dst + " = " + a + " - " + b;
+            case IROp::Mul:     return "  " + dst + " = " + a + " * " + b;
+            case IROp::Div:     return "  " + dst + " = " + a + " / " + b;
+            case IROp::Goto:    return "  goto " + label;
+            case IROp::IfFalse: return "  ifFalse " + a + " " + relop + " " + b + " goto " + label;
+            case IROp::Read:    return "  read " + dst;
+            case IROp::Print:   return "  print " + a;
+        }
+        return "";
+    }
+};
+
+class IRProgram {
+public:
+    vector<string> variables;  // declared with Var
+    vector<Instr> code;
+
+    // Temporaries are named t0, t1, ... skipping any name taken by a declared variable
+    string newTemp() {
+        string name;
+        do {
+            name = "t" + to_string(tempVarCount++);
+        } while (find(variables.begin(), variables.end(), name) != variables.end());
+        return name;
+    }
+
+    bool isTemp(const string& name) const {
+        return !name.empty() && !isConstant(name) &&
+               find(variables.begin(), variables.end(), name) == variables.end();
+    }
+
+    string newLabel() { return "L" + to_string(labelCount++); }
+
+    void emit(const Instr& in) { code.push_back(in); }
+
+    void print(ostream& out) const {
+        for (const auto& in : code) out << in.toString() << endl;
+    }
+
+private:
+    int tempVarCount = 0;
+    int labelCount = 0;
+};
+
+// ---------------------------------------------------------------------------
+// AST nodes; each one lowers itself into the IR
+// ---------------------------------------------------------------------------
+
 // Class for AST nodes
 class ASTNode {
 public:
-    virtual string generateIR() = 0;  // Function to generate intermediate code (IR)
+    virtual ~ASTNode() = default;
+    // Emits IR into the program; expressions return the operand holding their value
+    virtual string generateIR(IRProgram& ir) = 0;
 };
 
 // Value node class for numerical values
 class ValueNode : public ASTNode {
 public:
-    int value;
-    
-    ValueNode(int val) : value(val) {}
+    long long value;
+
+    ValueNode(long long val) : value(val) {}
 
-    string generateIR() override {
+    string generateIR(IRProgram&) override {
         return to_string(value);
     }
 };
 
-// Binary operator class for (+, -, =)
+// Variable reference
+class VariableNode : public ASTNode {
+public:
+    string name;
+
+    VariableNode(string n) : name(n) {}
+
+    string generateIR(IRProgram&) override {
+        return name;
+    }
+};
+
+// Binary operator class for (+, -)
 class BinaryOpNode : public ASTNode {
 public:
     string op;
@@ -28,43 +175,1979 @@ public:
     ASTNode* right;
 
     BinaryOpNode(string opr, ASTNode* l, ASTNode* r) : op(opr), left(l), right(r) {}
+    ~BinaryOpNode() { delete left; delete right; }
 
-    string generateIR() override {
-        string leftIR = left->generateIR();
-        string rightIR = right->generateIR();
+    string generateIR(IRProgram& ir) override {
+        string leftIR = left->generateIR(ir);
+        string rightIR = right->generateIR(ir);
 
         // Optimization: If both values are numeric, perform the operation directly
-        if (isdigit(leftIR[0]) && isdigit(rightIR[0])) {
-            int result = (op == "+") ? stoi(leftIR) + stoi(rightIR) : stoi(leftIR) - stoi(rightIR);
-            return to_string(result);
+        if (isConstant(leftIR) && isConstant(rightIR)) {
+            long long l = stoll(leftIR), r = stoll(rightIR);
+            return to_string(op == "+" ? wrapAdd(l, r) : wrapSub(l, r));
         }
 
         // Create a temporary variable to store the result
-        static int tempVarCount = 0;
-        string tempVar = "t" + to_string(tempVarCount++);
-        cout << tempVar << " = " << leftIR << " " << op << " " << rightIR << endl;
+        string tempVar = ir.newTemp();
+        ir.emit({op == "+" ? IROp::Add : IROp::Sub, tempVar, leftIR, rightIR});
         return tempVar;
     }
 };
 
-int main() {
-    // Constructing the AST for the statement: Put x = 5 + 3;
-    ASTNode* five = new ValueNode(5);
-    ASTNode* three = new ValueNode(3);
-    ASTNode* plus = new BinaryOpNode("+", five, three);
-    ASTNode* x = new ValueNode(0);  // Let's assume "x" is an integer
-    ASTNode* assignment = new BinaryOpNode("=", x, plus);
+// Put Identifier = <EXPR> ;
+class AssignNode : public ASTNode {
+public:
+    string name;
+    ASTNode* expr;
 
-    // Generate IR for the assignment
-    cout << "Intermediate Representation (IR):" << endl;
-    assignment->generateIR();
+    AssignNode(string n, ASTNode* e) : name(n), expr(e) {}
+    ~AssignNode() { delete expr; }
+
+    string generateIR(IRProgram& ir) override {
+        string value = expr->generateIR(ir);
+        // Write the last temporary straight into the variable instead of copying it
+        if (!ir.code.empty() && ir.code.back().dst == value && ir.isTemp(value) &&
+            (ir.code.back().op == IROp::Add || ir.code.back().op == IROp::Sub)) {
+            ir.code.back().dst = name;
+        } else {
+            ir.emit({IROp::Assign, name, value});
+        }
+        return "";
+    }
+};
+
+// Print ( <EXPR> ) ;
+class PrintNode : public ASTNode {
+public:
+    ASTNode* expr;
+
+    PrintNode(ASTNode* e) : expr(e) {}
+    ~PrintNode() { delete expr; }
+
+    string generateIR(IRProgram& ir) override {
+        ir.emit({IROp::Print, "", expr->generateIR(ir)});
+        return "";
+    }
+};
+
+// Read ( Identifier ) ;
+class ReadNode : public ASTNode {
+public:
+    string name;
+
+    ReadNode(string n) : name(n) {}
+
+    string generateIR(IRProgram& ir) override {
+        ir.emit({IROp::Read, name});
+        return "";
+    }
+};
+
+// <EXPR> <O> <EXPR> as used by If and Iteration
+struct Condition {
+    ASTNode* left;
+    string relop;
+    ASTNode* right;
+
+    // Emits "ifFalse left relop right goto target"
+    void generateJumpIfFalse(IRProgram& ir, const string& target) {
+        string l = left->generateIR(ir);
+        string r = right->generateIR(ir);
+        Instr in{IROp::IfFalse, "", l, r};
+        in.relop = relop;
+        in.label = target;
+        ir.emit(in);
+    }
+};
+
+// If ( <EXPR> <O> <EXPR> ) { <STATE> }
+class IfNode : public ASTNode {
+public:
+    Condition cond;
+    ASTNode* body;
+
+    IfNode(Condition c, ASTNode* b) : cond(c), body(b) {}
+    ~IfNode() { delete cond.left; delete cond.right; delete body; }
+
+    string generateIR(IRProgram& ir) override {
+        string endLabel = ir.newLabel();
+        cond.generateJumpIfFalse(ir, endLabel);
+        body->generateIR(ir);
+        Instr l{IROp::Label};
+        l.label = endLabel;
+        ir.emit(l);
+        return "";
+    }
+};
+
+// Iteration ( <EXPR> <O> <EXPR> ) { <STATE> }
+class IterationNode : public ASTNode {
+public:
+    Condition cond;
+    ASTNode* body;
+
+    IterationNode(Condition c, ASTNode* b) : cond(c), body(b) {}
+    ~IterationNode() { delete cond.left; delete cond.right; delete body; }
+
+    string generateIR(IRProgram& ir) override {
+        string headLabel = ir.newLabel();
+        string exitLabel = ir.newLabel();
+        Instr head{IROp::Label};
+        head.label = headLabel;
+        ir.emit(head);
+        cond.generateJumpIfFalse(ir, exitLabel);
+        body->generateIR(ir);
+        Instr back{IROp::Goto};
+        back.label = headLabel;
+        ir.emit(back);
+        Instr exit{IROp::Label};
+        exit.label = exitLabel;
+        ir.emit(exit);
+        return "";
+    }
+};
+
+// Start <STATES> End
+class BlockNode : public ASTNode {
+public:
+    vector<ASTNode*> statements;
+
+    ~BlockNode() { for (auto s : statements) delete s; }
+
+    string generateIR(IRProgram& ir) override {
+        for (auto s : statements) s->generateIR(ir);
+        return "";
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Lexer and recursive-descent parser for the README grammar
+// ---------------------------------------------------------------------------
+
+struct Token {
+    string kind;  // "Keyword", "Identifier", "Integer", "Symbol", "EOF"
+    string text;
+    int line;
+};
+
+vector<Token> tokenize(const string& input) {
+    static const unordered_set<string> keywords = {
+        "Program", "Var", "Start", "End", "end", "If", "Iteration", "Print", "Read", "Put"};
+    vector<Token> tokens;
+    int line = 1;
+    size_t pos = 0;
+    while (pos < input.size()) {
+        char c = input[pos];
+        if (c == '\n') line++;
+        if (isspace((unsigned char)c)) { pos++; continue; }
+        size_t start = pos;
+        if (isalpha((unsigned char)c)) {
+            while (pos < input.size() && (isalnum((unsigned char)input[pos]) || input[pos] == '_')) pos++;
+            string word = input.substr(start, pos - start);
+            tokens.push_back({keywords.count(word) ? "Keyword" : "Identifier", word, line});
+        } else if (isdigit((unsigned char)c)) {
+            while (pos < input.size() && isdigit((unsigned char)input[pos])) pos++;
+            tokens.push_back({"Integer", input.substr(start, pos - start), line});
+        } else if (c == '=' && pos + 1 < input.size() && input[pos + 1] == '=') {
+            tokens.push_back({"Symbol", "==", line});
+            pos += 2;
+        } else if (string("+-=<>;(){}").find(c) != string::npos) {
+            tokens.push_back({"Symbol", string(1, c), line});
+            pos++;
+        } else {
+            throw runtime_error("line " + to_string(line) + ": unknown character '" + string(1, c) + "'");
+        }
+    }
+    tokens.push_back({"EOF", "", line});
+    return tokens;
+}
+
+class Parser {
+public:
+    Parser(const vector<Token>& t) : tokens(t) {}
+
+    // <S> => Program <VARS> <BLOCKS> end
+    BlockNode* parseProgram(vector<string>& variables) {
+        expect("Program");
+        while (accept("Var")) {
+            variables.push_back(expectIdentifier());
+            expect(";");
+        }
+        BlockNode* block = parseBlock();
+        // The README spells the terminator "end"; most inputs use "End" or leave it out
+        if (peek().kind != "EOF" && !accept("end")) expect("End");
+        return block;
+    }
+
+private:
+    const vector<Token>& tokens;
+    size_t pos = 0;
+
+    const Token& peek() const { return tokens[pos]; }
+
+    bool accept(const string& text) {
+        if (peek().kind != "EOF" && peek().kind != "Identifier" && peek().kind != "Integer" &&
+            peek().text == text) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(const string& text) {
+        if (!accept(text)) error("expected '" + text + "'");
+    }
+
+    string expectIdentifier() {
+        if (peek().kind != "Identifier") error("expected identifier");
+        return tokens[pos++].text;
+    }
+
+    [[noreturn]] void error(const string& msg) const {
+        throw runtime_error("line " + to_string(peek().line) + ": " + msg +
+                            " but found '" + peek().text + "'");
+    }
+
+    // <BLOCKS> => Start <STATES> End
+    BlockNode* parseBlock() {
+        expect("Start");
+        BlockNode* block = new BlockNode();
+        do {
+            block->statements.push_back(parseState());
+        } while (peek().text != "End");
+        expect("End");
+        return block;
+    }
+
+    ASTNode* parseState() {
+        if (peek().text == "Start") return parseBlock();
+        if (accept("Print")) {
+            expect("(");
+            ASTNode* e = parseExpr();
+            expect(")");
+            expect(";");
+            return new PrintNode(e);
+        }
+        if (accept("Read")) {
+            expect("(");
+            string id = expectIdentifier();
+            expect(")");
+            expect(";");
+            return new ReadNode(id);
+        }
+        if (accept("Put")) {
+            string id = expectIdentifier();
+            expect("=");
+            ASTNode* e = parseExpr();
+            expect(";");
+            return new AssignNode(id, e);
+        }
+        if (accept("If")) {
+            Condition c = parseCondition();
+            return new IfNode(c, parseBraced());
+        }
+        if (accept("Iteration")) {
+            Condition c = parseCondition();
+            return new IterationNode(c, parseBraced());
+        }
+        error("expected statement");
+    }
+
+    ASTNode* parseBraced() {
+        expect("{");
+        ASTNode* s = parseState();
+        expect("}");
+        return s;
+    }
+
+    Condition parseCondition() {
+        expect("(");
+        Condition c;
+        c.left = parseExpr();
+        if (peek().text != "<" && peek().text != ">" && peek().text != "==") error("expected comparison");
+        c.relop = tokens[pos++].text;
+        c.right = parseExpr();
+        expect(")");
+        return c;
+    }
+
+    // <EXPR> => <EXPR> + <R> | <EXPR> - <R> | <R>
+    ASTNode* parseExpr() {
+        ASTNode* node = parseR();
+        while (peek().text == "+" || peek().text == "-") {
+            string op = tokens[pos++].text;
+            node = new BinaryOpNode(op, node, parseR());
+        }
+        return node;
+    }
+
+    // <R> => Identifier | Integer
+    ASTNode* parseR() {
+        if (peek().kind == "Identifier") return new VariableNode(tokens[pos++].text);
+        if (peek().kind == "Integer") return new ValueNode(stoll(tokens[pos++].text));
+        error("expected identifier or integer");
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Control-flow graph, dominators and liveness
+// ---------------------------------------------------------------------------
+
+struct BasicBlock {
+    size_t begin, end;  // instruction range [begin, end)
+    vector<int> succs, preds;
+};
+
+class CFG {
+public:
+    vector<BasicBlock> blocks;
+    vector<int> blockOf;  // instruction index -> block
+    vector<int> idom;     // immediate dominator, -1 for the entry / unreachable blocks
+    vector<int> rpo;      // reachable blocks in reverse post-order
+
+    CFG(const vector<Instr>& code) {
+        buildBlocks(code);
+        computeDominators();
+    }
+
+    bool dominates(int a, int b) const {
+        while (b != -1) {
+            if (a == b) return true;
+            b = idom[b];
+        }
+        return false;
+    }
+
+    bool reachable(int b) const { return rpoIndex[b] >= 0; }
+
+private:
+    vector<int> rpoIndex;
+
+    void buildBlocks(const vector<Instr>& code) {
+        blockOf.assign(code.size(), -1);
+        unordered_map<string, int> labelBlock;
+        size_t i = 0;
+        while (i < code.size()) {
+            BasicBlock b;
+            b.begin = i;
+            // A block starts at a label (or after a jump) and ends after a jump
+            do {
+                blockOf[i] = (int)blocks.size();
+                if (code[i].isJump()) { i++; break; }
+                i++;
+            } while (i < code.size() && code[i].op != IROp::Label);
+            b.end = i;
+            if (code[b.begin].op == IROp::Label) labelBlock[code[b.begin].label] = (int)blocks.size();
+            blocks.push_back(b);
+        }
+        for (size_t n = 0; n < blocks.size(); n++) {
+            const Instr& last = code[blocks[n].end - 1];
+            if (last.isJump()) blocks[n].succs.push_back(labelBlock.at(last.label));
+            if (last.op != IROp::Goto && n + 1 < blocks.size() &&
+                (blocks[n].succs.empty() || blocks[n].succs[0] != (int)n + 1))
+                blocks[n].succs.push_back((int)n + 1);
+            for (int s : blocks[n].succs) blocks[s].preds.push_back((int)n);
+        }
+    }
+
+    // Cooper, Harvey and Kennedy's iterative algorithm
+    void computeDominators() {
+        size_t n = blocks.size();
+        idom.assign(n, -1);
+        rpoIndex.assign(n, -1);
+        if (n == 0) return;
+        vector<int> post;
+        vector<char> seen(n, 0);
+        vector<pair<int, size_t>> stack = {{0, 0}};
+        seen[0] = 1;
+        while (!stack.empty()) {
+            auto& [b, k] = stack.back();
+            if (k < blocks[b].succs.size()) {
+                int s = blocks[b].succs[k++];
+                if (!seen[s]) { seen[s] = 1; stack.push_back({s, 0}); }
+            } else {
+                post.push_back(b);
+                stack.pop_back();
+            }
+        }
+        rpo.assign(post.rbegin(), post.rend());
+        for (size_t k = 0; k < rpo.size(); k++) rpoIndex[rpo[k]] = (int)k;
+
+        idom[0] = 0;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t k = 1; k < rpo.size(); k++) {
+                int b = rpo[k], newIdom = -1;
+                for (int p : blocks[b].preds) {
+                    if (rpoIndex[p] < 0 || idom[p] == -1) continue;
+                    newIdom = newIdom == -1 ? p : intersect(p, newIdom);
+                }
+                if (newIdom != idom[b]) { idom[b] = newIdom; changed = true; }
+            }
+        }
+        idom[0] = -1;
+    }
+
+    int intersect(int a, int b) const {
+        while (a != b) {
+            while (rpoIndex[a] > rpoIndex[b]) a = idom[a];
+            while (rpoIndex[b] > rpoIndex[a]) b = idom[b];
+        }
+        return a;
+    }
+};
+
+// Backward live-variable analysis over the blocks of a CFG. Names are
+// numbered and each live set is a sorted vector of those numbers.
+class Liveness {
+public:
+    vector<string> names;
+    vector<vector<int>> liveIn, liveOut;
+
+    Liveness(const CFG& cfg, const vector<Instr>& code) {
+        size_t n = cfg.blocks.size();
+        vector<vector<int>> use(n), def(n);
+        for (size_t b = 0; b < n; b++) {
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+                for (const auto& u : code[i].uses()) {
+                    int id = number(u);
+                    if (find(def[b].begin(), def[b].end(), id) == def[b].end()) use[b].push_back(id);
+                }
+                if (!code[i].def().empty()) def[b].push_back(number(code[i].def()));
+            }
+            sortUnique(use[b]);
+            sortUnique(def[b]);
+        }
+        liveIn.assign(n, {});
+        liveOut.assign(n, {});
+        vector<int> out, in, scratch;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t k = cfg.rpo.size(); k-- > 0;) {
+                int b = cfg.rpo[k];
+                out.clear();
+                for (int s : cfg.blocks[b].succs) {
+                    scratch.clear();
+                    set_union(out.begin(), out.end(), liveIn[s].begin(), liveIn[s].end(), back_inserter(scratch));
+                    out.swap(scratch);
+                }
+                // in = use + (out - def)
+                scratch.clear();
+                set_difference(out.begin(), out.end(), def[b].begin(), def[b].end(), back_inserter(scratch));
+                in.clear();
+                set_union(use[b].begin(), use[b].end(), scratch.begin(), scratch.end(), back_inserter(in));
+                if (in != liveIn[b] || out != liveOut[b]) {
+                    liveIn[b] = in;
+                    liveOut[b] = out;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Number of a name seen by the analysis, or -1
+    int idOf(const string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    bool isLiveIn(int block, const string& name) const {
+        auto it = ids.find(name);
+        return it != ids.end() && binary_search(liveIn[block].begin(), liveIn[block].end(), it->second);
+    }
+
+private:
+    unordered_map<string, int> ids;
+
+    int number(const string& name) {
+        auto [it, inserted] = ids.emplace(name, (int)names.size());
+        if (inserted) names.push_back(name);
+        return it->second;
+    }
+
+    static void sortUnique(vector<int>& v) {
+        sort(v.begin(), v.end());
+        v.erase(unique(v.begin(), v.end()), v.end());
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Natural loops and loop-invariant code motion
+// ---------------------------------------------------------------------------
+
+struct Loop {
+    int header;
+    vector<int> latches;  // sources of back edges
+    set<int> blocks;
+};
+
+// One natural loop per header: the union of the loops of all its back edges
+vector<Loop> findLoops(const CFG& cfg) {
+    map<int, Loop> byHeader;
+    for (int b : cfg.rpo) {
+        for (int s : cfg.blocks[b].succs) {
+            if (!cfg.dominates(s, b)) continue;
+            Loop& loop = byHeader[s];
+            loop.header = s;
+            loop.latches.push_back(b);
+            loop.blocks.insert(s);
+            vector<int> work = {b};
+            while (!work.empty()) {
+                int x = work.back();
+                work.pop_back();
+                if (!loop.blocks.insert(x).second) continue;
+                for (int p : cfg.blocks[x].preds)
+                    if (cfg.reachable(p)) work.push_back(p);
+            }
+        }
+    }
+    vector<Loop> loops;
+    for (auto& [h, loop] : byHeader) loops.push_back(loop);
+    // Innermost loops first so hoisted code can keep moving outwards
+    sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) { return a.blocks.size() < b.blocks.size(); });
+    return loops;
+}
+
+// Rebuilds the code with a new block holding `preheader` in front of the loop
+// header, dropping the instructions flagged in `removed`. Jumps into the loop
+// from outside are retargeted so that every entry runs the preheader.
+void insertPreheader(IRProgram& ir, const CFG& cfg, const Loop& loop,
+                     const vector<Instr>& preheader, const vector<char>& removed) {
+    const vector<Instr>& code = ir.code;
+    Instr label{IROp::Label};
+    label.label = ir.newLabel();
+    const string headerLabel = code[cfg.blocks[loop.header].begin].label;
+    vector<Instr> block;
+    int layoutPred = loop.header - 1;
+    if (layoutPred >= 0 && loop.blocks.count(layoutPred) &&
+        code[cfg.blocks[layoutPred].end - 1].op != IROp::Goto) {
+        // A loop block falls through into the header; keep it off the preheader
+        Instr jump{IROp::Goto};
+        jump.label = headerLabel;
+        block.push_back(jump);
+    }
+    block.push_back(label);
+    block.insert(block.end(), preheader.begin(), preheader.end());
+
+    vector<Instr> result;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (i == cfg.blocks[loop.header].begin) result.insert(result.end(), block.begin(), block.end());
+        if (removed[i]) continue;
+        Instr in = code[i];
+        if (in.isJump() && in.label == headerLabel && !loop.blocks.count(cfg.blockOf[i]))
+            in.label = label.label;
+        result.push_back(in);
+    }
+    ir.code = move(result);
+}
+
+class LICM {
+public:
+    LICM(IRProgram& ir) : ir(ir) {}
+
+    // Returns the number of hoisted instructions
+    int run() {
+        int total = 0;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            CFG cfg(ir.code);
+            for (const Loop& loop : findLoops(cfg)) {
+                int n = hoist(cfg, loop);
+                if (n > 0) {
+                    total += n;
+                    changed = true;
+                    break;  // the code moved; recompute the CFG
+                }
+            }
+        }
+        return total;
+    }
+
+private:
+    IRProgram& ir;
+
+    int hoist(const CFG& cfg, const Loop& loop) {
+        const vector<Instr>& code = ir.code;
+        Liveness live(cfg, code);
+
+        vector<size_t> body;
+        for (int b : loop.blocks)
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) body.push_back(i);
+        sort(body.begin(), body.end());
+
+        unordered_map<string, int> defsInLoop;
+        for (size_t i : body)
+            if (!code[i].def().empty()) defsInLoop[code[i].def()]++;
+
+        vector<pair<int, int>> exits;  // (exiting block, target outside the loop)
+        for (int b : loop.blocks)
+            for (int s : cfg.blocks[b].succs)
+                if (!loop.blocks.count(s)) exits.push_back({b, s});
+
+        auto invariant = [&](const string& operand) {
+            return operand.empty() || isConstant(operand) || defsInLoop[operand] == 0;
+        };
+
+        vector<char> moved(code.size(), 0);
+        vector<size_t> hoisted;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i : body) {
+                const Instr& in = code[i];
+                if (moved[i]) continue;
+                if (in.op != IROp::Assign && !in.isArithmetic()) continue;
+                if (!invariant(in.a) || !invariant(in.b)) continue;
+                // The only definition in the loop, and no use can see an earlier value
+                if (defsInLoop[in.dst] != 1 || live.isLiveIn(loop.header, in.dst)) continue;
+                // The value after the loop is unchanged even if the body never runs
+                int defBlock = cfg.blockOf[i];
+                bool safe = true;
+                for (auto [from, to] : exits)
+                    if (!cfg.dominates(defBlock, from) && live.isLiveIn(to, in.dst)) safe = false;
+                if (!safe) continue;
+                moved[i] = 1;
+                hoisted.push_back(i);
+                defsInLoop[in.dst] = 0;
+                changed = true;
+            }
+        }
+        if (hoisted.empty()) return 0;
+
+        // Hoisted code keeps its original relative order
+        sort(hoisted.begin(), hoisted.end());
+        vector<Instr> preheader;
+        for (size_t i : hoisted) preheader.push_back(code[i]);
+        insertPreheader(ir, cfg, loop, preheader, moved);
+        return (int)hoisted.size();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Induction variables: closed-form loop evaluation and update combining
+// ---------------------------------------------------------------------------
+
+// A variable whose every definition in the loop is v = v + x, v = x + v or
+// v = v - x with x loop-invariant. Each iteration adds the sum of its increments.
+struct InductionVariable {
+    vector<size_t> defs;
+    vector<pair<char, string>> increments;  // ('+' or '-', invariant operand) in program order
 
-    // Free memory
-    delete five;
-    delete three;
-    delete plus;
-    delete x;
-    delete assignment;
+    bool constantStep() const {
+        for (const auto& inc : increments)
+            if (!isConstant(inc.second)) return false;
+        return true;
+    }
+
+    long long step() const {
+        long long total = 0;
+        for (const auto& [sign, x] : increments)
+            if (isConstant(x)) total = sign == '+' ? wrapAdd(total, stoll(x)) : wrapSub(total, stoll(x));
+        return total;
+    }
+
+    // Returns an operand holding the per-iteration step, emitting code for the
+    // non-constant part of it into `out`
+    string emitStep(IRProgram& ir, vector<Instr>& out) const {
+        if (constantStep()) return to_string(step());
+        string total = ir.newTemp();
+        bool first = true;
+        for (const auto& [sign, x] : increments) {
+            if (isConstant(x)) continue;
+            if (first && sign == '+') out.push_back({IROp::Assign, total, x});
+            else out.push_back({sign == '+' ? IROp::Add : IROp::Sub, total, first ? "0" : total, x});
+            first = false;
+        }
+        if (step() != 0) out.push_back({IROp::Add, total, total, to_string(step())});
+        return total;
+    }
+};
+
+class InductionVariables {
+public:
+    int closedForms = 0;  // loops replaced by closed-form arithmetic
+    int combined = 0;     // increments folded into a single update
+
+    InductionVariables(IRProgram& ir) : ir(ir) {}
+
+    void run() {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            CFG cfg(ir.code);
+            for (const Loop& loop : findLoops(cfg)) {
+                if (transform(cfg, loop)) {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    IRProgram& ir;
+    set<string> versioned;  // headers of loops kept as the fallback of a closed form
+
+    // Trip counts are only computed when the counter and its bound stay within
+    // +-2^61, so the arithmetic below cannot overflow; other inputs take the loop.
+    static constexpr long long rangeLimit = 1LL << 61;
+
+    bool transform(const CFG& cfg, const Loop& loop) {
+        const vector<Instr>& code = ir.code;
+        const string& headerLabel = code[cfg.blocks[loop.header].begin].label;
+        if (versioned.count(headerLabel)) return false;
+
+        vector<size_t> body;
+        for (int b : loop.blocks)
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) body.push_back(i);
+        sort(body.begin(), body.end());
+
+        unordered_map<string, int> defsInLoop;
+        for (size_t i : body)
+            if (!code[i].def().empty()) defsInLoop[code[i].def()]++;
+        auto invariant = [&](const string& x) { return isConstant(x) || defsInLoop[x] == 0; };
+
+        map<string, InductionVariable> ivs;
+        set<string> others;
+        for (size_t i : body) {
+            const Instr& in = code[i];
+            const string& v = in.def();
+            if (v.empty()) continue;
+            if (in.op == IROp::Add && in.a == v && in.b != v && invariant(in.b)) {
+                ivs[v].increments.push_back({'+', in.b});
+            } else if (in.op == IROp::Add && in.b == v && in.a != v && invariant(in.a)) {
+                ivs[v].increments.push_back({'+', in.a});
+            } else if (in.op == IROp::Sub && in.a == v && in.b != v && invariant(in.b)) {
+                ivs[v].increments.push_back({'-', in.b});
+            } else {
+                others.insert(v);
+                continue;
+            }
+            ivs[v].defs.push_back(i);
+        }
+        for (const auto& v : others) ivs.erase(v);
+        if (ivs.empty()) return false;
+
+        Liveness live(cfg, code);
+        if (evaluateClosedForm(cfg, loop, live, ivs, others)) return true;
+        return combineUpdates(cfg, loop, ivs);
+    }
+
+    // Replaces a counting loop by its final values:
+    //   v = v + trips * step(v) for every induction variable v
+    // The original loop stays behind as the fallback for counters outside the safe range.
+    bool evaluateClosedForm(const CFG& cfg, const Loop& loop, const Liveness& live,
+                            const map<string, InductionVariable>& ivs, const set<string>& others) {
+        const vector<Instr>& code = ir.code;
+        const BasicBlock& header = cfg.blocks[loop.header];
+        if (loop.latches.size() != 1 || header.end - header.begin != 2) return false;
+        const Instr test = code[header.begin + 1];
+        if (test.op != IROp::IfFalse || test.relop == "==") return false;
+        int exitBlock = cfg.blocks[loop.header].succs[0];
+        if (loop.blocks.count(exitBlock)) return false;
+
+        // The rest of the loop must be straight-line arithmetic ending in the back edge
+        for (int b : loop.blocks) {
+            if (b == loop.header) continue;
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++) {
+                const Instr& in = code[i];
+                if (in.op == IROp::Label || in.isArithmetic() || in.op == IROp::Assign) continue;
+                if (in.op == IROp::Goto && b == loop.latches[0] && i + 1 == cfg.blocks[b].end) continue;
+                return false;
+            }
+            if (!cfg.dominates(b, loop.latches[0])) return false;
+        }
+        // Anything else computed in the loop must be scratch that nobody reads afterwards
+        for (const auto& v : others)
+            if (live.isLiveIn(loop.header, v) || live.isLiveIn(exitBlock, v)) return false;
+
+        // Normalize the test to "counter relop bound" while the body runs
+        string counter = test.a, bound = test.b, relop = test.relop;
+        if (!ivs.count(counter)) {
+            swap(counter, bound);
+            relop = relop == "<" ? ">" : "<";
+        }
+        if (!ivs.count(counter) || ivs.count(bound) || others.count(bound)) return false;
+        const InductionVariable& iv = ivs.at(counter);
+        if (!iv.constantStep()) return false;
+        long long step = iv.step();
+        bool up = relop == "<";
+        if ((up && step <= 0) || (!up && step >= 0) || step >= rangeLimit || step <= -rangeLimit) return false;
+        long long stride = up ? step : -step;
 
+        const string exitLabel = test.label;
+        const string slowLabel = ir.newLabel();
+        vector<Instr> fast;
+        auto label = [](const string& name) { Instr in{IROp::Label}; in.label = name; return in; };
+        auto branch = [](const string& a, const string& relop, const string& b, const string& target) {
+            Instr in{IROp::IfFalse, "", a, b};
+            in.relop = relop;
+            in.label = target;
+            return in;
+        };
+        auto arith = [](IROp op, const string& dst, const string& a, const string& b) {
+            return Instr{op, dst, a, b};
+        };
+
+        fast.push_back(label(code[header.begin].label));
+        string low = to_string(-rangeLimit), high = to_string(rangeLimit);
+        fast.push_back(branch(counter, ">", low, slowLabel));
+        fast.push_back(branch(counter, "<", high, slowLabel));
+        if (!isConstant(bound)) {
+            fast.push_back(branch(bound, ">", low, slowLabel));
+            fast.push_back(branch(bound, "<", high, slowLabel));
+        }
+        fast.push_back(branch(counter, relop, bound, exitLabel));
+        // trips = ceil(distance / stride)
+        string trips = ir.newTemp();
+        fast.push_back(up ? arith(IROp::Sub, trips, bound, counter) : arith(IROp::Sub, trips, counter, bound));
+        if (stride != 1) {
+            fast.push_back(arith(IROp::Add, trips, trips, to_string(stride - 1)));
+            fast.push_back(arith(IROp::Div, trips, trips, to_string(stride)));
+        }
+        for (const auto& [v, ind] : ivs) {
+            string stepOperand = ind.emitStep(ir, fast);
+            if (stepOperand == "0") continue;
+            if (stepOperand == "1") {
+                fast.push_back(arith(IROp::Add, v, v, trips));
+            } else {
+                string delta = ir.newTemp();
+                fast.push_back(arith(IROp::Mul, delta, trips, stepOperand));
+                fast.push_back(arith(IROp::Add, v, v, delta));
+            }
+        }
+        Instr done{IROp::Goto};
+        done.label = exitLabel;
+        fast.push_back(done);
+
+        // Splice the fast path in front of the loop, which moves to a fresh header label
+        const string headerLabel = code[header.begin].label;
+        vector<Instr> result;
+        for (size_t i = 0; i < code.size(); i++) {
+            Instr in = code[i];
+            if (i == header.begin) {
+                result.insert(result.end(), fast.begin(), fast.end());
+                in.label = slowLabel;
+            } else if (in.isJump() && in.label == headerLabel && loop.blocks.count(cfg.blockOf[i])) {
+                in.label = slowLabel;
+            }
+            result.push_back(in);
+        }
+        ir.code = move(result);
+        versioned.insert(slowLabel);
+        closedForms++;
+        return true;
+    }
+
+    // Folds several increments of one variable within a block into a single
+    // update by a step computed once in the preheader (or at compile time)
+    bool combineUpdates(const CFG& cfg, const Loop& loop, const map<string, InductionVariable>& ivs) {
+        const vector<Instr>& code = ir.code;
+        vector<Instr> preheader;
+        vector<char> removed(code.size(), 0);
+        vector<pair<size_t, Instr>> replaced;
+        for (const auto& [v, ind] : ivs) {
+            if (ind.defs.size() < 2) continue;
+            size_t first = ind.defs.front(), last = ind.defs.back();
+            if (cfg.blockOf[first] != cfg.blockOf[last]) continue;
+            // Nothing in between may observe a partial sum
+            bool observed = false;
+            for (size_t i = first + 1; i < last && !observed; i++) {
+                if (find(ind.defs.begin(), ind.defs.end(), i) != ind.defs.end()) continue;
+                for (const auto& u : code[i].uses()) observed |= u == v;
+            }
+            if (observed) continue;
+
+            string stepOperand = ind.emitStep(ir, preheader);
+            replaced.push_back({first, Instr{IROp::Add, v, v, stepOperand}});
+            for (size_t i : ind.defs)
+                if (i != first) removed[i] = 1;
+            combined += (int)ind.defs.size() - 1;
+        }
+        if (replaced.empty()) return false;
+        for (auto& [i, in] : replaced) ir.code[i] = in;
+        if (preheader.empty()) {
+            vector<Instr> result;
+            for (size_t i = 0; i < code.size(); i++)
+                if (!removed[i]) result.push_back(code[i]);
+            ir.code = move(result);
+        } else {
+            insertPreheader(ir, cfg, loop, preheader, removed);
+        }
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Live intervals and linear-scan register allocation for x86-64
+// ---------------------------------------------------------------------------
+
+// Lifetime of one variable or temporary over the instruction numbering,
+// widened to cover every block it is live through (Poletto and Sarkar)
+struct LiveInterval {
+    string name;
+    int start, end;            // first and last instruction index, inclusive
+    bool crossesCall = false;  // live across a Read/Print runtime call
+    string reg{};              // assigned register, or "" when spilled
+    int slot = -1;             // stack slot when spilled
+};
+
+class RegisterAllocator {
+public:
+    // rax and rdx are left for division and runtime calls, r11 for reloading spills
+    static const vector<string>& calleeSaved() {
+        static const vector<string> regs = {"%rbx", "%r12", "%r13", "%r14", "%r15"};
+        return regs;
+    }
+    static const vector<string>& callerSaved() {
+        static const vector<string> regs = {"%rcx", "%rsi", "%rdi", "%r8", "%r9", "%r10"};
+        return regs;
+    }
+
+    vector<LiveInterval> intervals;  // sorted by start
+    int spills = 0;
+    int stackSlots = 0;
+
+    // registerLimit caps the allocatable registers, callee-saved ones first
+    RegisterAllocator(const IRProgram& ir, size_t registerLimit = 11) : ir(ir) {
+        for (const auto& r : calleeSaved())
+            if (registers.size() < registerLimit) registers.push_back(r);
+        for (const auto& r : callerSaved())
+            if (registers.size() < registerLimit) registers.push_back(r);
+    }
+
+    void run() {
+        buildIntervals();
+        linearScan();
+    }
+
+    // Register or frame location of a variable
+    string location(const string& name) const {
+        if (isConstant(name)) return "$" + name;
+        const LiveInterval& in = intervals[byName.at(name)];
+        return in.slot >= 0 ? to_string(-8 * (in.slot + 1)) + "(%rbp)" : in.reg;
+    }
+
+    bool hasLocation(const string& name) const { return byName.count(name) > 0; }
+
+    void print(ostream& out) const {
+        for (const auto& in : intervals)
+            out << "  " << in.name << " [" << in.start << ", " << in.end << "] -> " << location(in.name)
+                << (in.crossesCall ? "  (across call)" : "") << endl;
+        out << "Spilled " << spills << " of " << intervals.size() << " intervals, "
+            << stackSlots << " stack slots" << endl;
+    }
+
+private:
+    const IRProgram& ir;
+    vector<string> registers;
+    unordered_map<string, int> byName;
+
+    void buildIntervals() {
+        const auto& code = ir.code;
+        CFG cfg(code);
+        Liveness live(cfg, code);
+        // Indexed by the liveness numbering of each name
+        vector<pair<int, int>> range(live.names.size(), {INT_MAX, -1});
+        auto extend = [&](int v, int at) {
+            range[v] = {min(range[v].first, at), max(range[v].second, at)};
+        };
+        vector<int> calls;
+        for (size_t b = 0; b < cfg.blocks.size(); b++) {
+            const BasicBlock& block = cfg.blocks[b];
+            // Values live into the entry are set up before the first instruction, which may be a call
+            for (int v : live.liveIn[b]) extend(v, b == 0 ? -1 : (int)block.begin);
+            for (int v : live.liveOut[b]) extend(v, (int)block.end - 1);
+            for (size_t i = block.begin; i < block.end; i++) {
+                for (const auto& u : code[i].uses()) extend(live.idOf(u), (int)i);
+                if (!code[i].def().empty()) extend(live.idOf(code[i].def()), (int)i);
+                if (code[i].op == IROp::Read || code[i].op == IROp::Print) calls.push_back((int)i);
+            }
+        }
+        intervals.clear();
+        for (size_t v = 0; v < range.size(); v++) {
+            auto [start, end] = range[v];
+            if (end < 0) continue;
+            LiveInterval in{live.names[v], start, end};
+            // The first call strictly after the start decides whether the interval spans one
+            auto next = upper_bound(calls.begin(), calls.end(), start);
+            in.crossesCall = next != calls.end() && *next < end;
+            intervals.push_back(in);
+        }
+        sort(intervals.begin(), intervals.end(), [](const LiveInterval& a, const LiveInterval& b) {
+            return a.start != b.start ? a.start < b.start : a.name < b.name;
+        });
+        byName.clear();
+        for (size_t i = 0; i < intervals.size(); i++) byName[intervals[i].name] = (int)i;
+    }
+
+    static bool isCalleeSaved(const string& reg) {
+        return find(calleeSaved().begin(), calleeSaved().end(), reg) != calleeSaved().end();
+    }
+
+    void spill(LiveInterval& in) {
+        in.reg.clear();
+        in.slot = stackSlots++;
+        spills++;
+    }
+
+    void linearScan() {
+        spills = stackSlots = 0;
+        vector<int> active;  // indices into intervals, ordered by increasing end
+        set<string> freeRegs(registers.begin(), registers.end());
+        for (size_t i = 0; i < intervals.size(); i++) {
+            LiveInterval& current = intervals[i];
+            // Expire intervals that ended before this one starts
+            while (!active.empty() && intervals[active.front()].end < current.start) {
+                freeRegs.insert(intervals[active.front()].reg);
+                active.erase(active.begin());
+            }
+            // Values live across a call must survive it in a callee-saved register
+            string chosen;
+            for (const auto& r : registers) {
+                if (freeRegs.count(r) && (!current.crossesCall || isCalleeSaved(r))) {
+                    chosen = r;
+                    break;
+                }
+            }
+            if (chosen.empty()) {
+                // Spill whichever usable interval ends last
+                int victim = -1;
+                for (size_t k = active.size(); k-- > 0;) {
+                    const LiveInterval& a = intervals[active[k]];
+                    if (!current.crossesCall || isCalleeSaved(a.reg)) {
+                        victim = (int)k;
+                        break;
+                    }
+                }
+                if (victim < 0 || intervals[active[victim]].end <= current.end) {
+                    spill(current);
+                    continue;
+                }
+                LiveInterval& evicted = intervals[active[victim]];
+                chosen = evicted.reg;
+                spill(evicted);
+                active.erase(active.begin() + victim);
+                freeRegs.insert(chosen);
+            }
+            current.reg = chosen;
+            freeRegs.erase(chosen);
+            auto pos = upper_bound(active.begin(), active.end(), (int)i, [&](int x, int y) {
+                return intervals[x].end < intervals[y].end;
+            });
+            active.insert(pos, (int)i);
+        }
+    }
+};
+
+// Prints the IR with every name replaced by its machine location
+void printAllocated(const IRProgram& ir, const RegisterAllocator& ra, ostream& out) {
+    for (Instr in : ir.code) {
+        for (string* operand : {&in.dst, &in.a, &in.b})
+            if (!operand->empty() && ra.hasLocation(*operand)) *operand = ra.location(*operand);
+        out << in.toString() << endl;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// x86-64 System V assembly back end (AT&T syntax)
+// ---------------------------------------------------------------------------
+
+// Sink for the instructions chosen by AsmGenerator. Operands use AT&T
+// syntax, source first: "%rbx", "-8(%rbp)", "$5", or a label/symbol name.
+class Assembler {
+public:
+    virtual ~Assembler() = default;
+    virtual void directive(const string&) {}
+    virtual void label(const string& name) = 0;
+    virtual void instruction(const string& mnemonic, const vector<string>& operands = {}) = 0;
+};
+
+// Writes assembler source for the system assembler
+class TextAssembler : public Assembler {
+public:
+    TextAssembler(ostream& out) : out(out) {}
+
+    void directive(const string& text) override { out << text << "\n"; }
+
+    void label(const string& name) override { out << name << ":\n"; }
+
+    void instruction(const string& mnemonic, const vector<string>& operands) override {
+        out << "    " << mnemonic;
+        for (size_t k = 0; k < operands.size(); k++) out << (k ? ", " : " ") << operands[k];
+        out << "\n";
+    }
+
+private:
+    ostream& out;
+};
+
+// Emits a function for the allocated IR. Read and Print call simple_read and
+// simple_print from the runtime; %rax, %rdx and %r11 are scratch registers.
+class AsmGenerator {
+public:
+    AsmGenerator(const IRProgram& ir, const RegisterAllocator& ra) : ir(ir), ra(ra) {}
+
+    void generate(Assembler& as, const string& name = "main") {
+        const auto& code = ir.code;
+        // Callee-saved registers in use are stored below the spill slots
+        vector<string> saved;
+        for (const auto& r : RegisterAllocator::calleeSaved())
+            for (const auto& in : ra.intervals)
+                if (in.reg == r) { saved.push_back(r); break; }
+        int frame = 8 * (ra.stackSlots + (int)saved.size());
+        frame = (frame + 15) / 16 * 16;
+
+        as.directive("    .text");
+        as.directive("    .globl " + name);
+        as.label(name);
+        as.instruction("pushq", {"%rbp"});
+        as.instruction("movq", {"%rsp", "%rbp"});
+        if (frame) as.instruction("subq", {"$" + to_string(frame), "%rsp"});
+        for (size_t k = 0; k < saved.size(); k++)
+            as.instruction("movq", {saved[k], savedSlot(k)});
+
+        // Variables read before any assignment start out as 0
+        CFG cfg(code);
+        Liveness live(cfg, code);
+        if (!cfg.blocks.empty())
+            for (int v : live.liveIn[0]) as.instruction("movq", {"$0", ra.location(live.names[v])});
+
+        for (const auto& in : code) {
+            switch (in.op) {
+                case IROp::Label: as.label(".L" + in.label); break;
+                case IROp::Assign: move(as, in.a, in.dst); break;
+                case IROp::Add: arithmetic(as, "addq", in, true); break;
+                case IROp::Sub: arithmetic(as, "subq", in, false); break;
+                case IROp::Mul: arithmetic(as, "imulq", in, true); break;
+                case IROp::Div:
+                    load(as, in.a, "%rax");
+                    as.instruction("cqto");
+                    load(as, in.b, "%r11");
+                    as.instruction("idivq", {"%r11"});
+                    as.instruction("movq", {"%rax", ra.location(in.dst)});
+                    break;
+                case IROp::Goto: as.instruction("jmp", {".L" + in.label}); break;
+                case IROp::IfFalse: {
+                    // cmpq needs a register or memory on the left and at most one memory operand
+                    string left = ra.location(in.a);
+                    if (left[0] == '$') {
+                        load(as, in.a, "%rax");
+                        left = "%rax";
+                    }
+                    string right = source(as, in.b);
+                    if (!isRegister(left) && !isRegister(right) && right[0] != '$') {
+                        load(as, in.a, "%rax");
+                        left = "%rax";
+                    }
+                    as.instruction("cmpq", {right, left});
+                    string jump = in.relop == "<" ? "jge" : in.relop == ">" ? "jle" : "jne";
+                    as.instruction(jump, {".L" + in.label});
+                    break;
+                }
+                case IROp::Read:
+                    as.instruction("call", {"simple_read"});
+                    as.instruction("movq", {"%rax", ra.location(in.dst)});
+                    break;
+                case IROp::Print:
+                    load(as, in.a, "%rdi");
+                    as.instruction("call", {"simple_print"});
+                    break;
+            }
+        }
+
+        as.instruction("call", {"simple_flush"});
+        for (size_t k = 0; k < saved.size(); k++)
+            as.instruction("movq", {savedSlot(k), saved[k]});
+        as.instruction("xorl", {"%eax", "%eax"});
+        as.instruction("leave");
+        as.instruction("ret");
+        as.directive("    .section .note.GNU-stack,\"\",@progbits");
+    }
+
+private:
+    const IRProgram& ir;
+    const RegisterAllocator& ra;
+
+    string savedSlot(size_t k) const { return to_string(-8 * (ra.stackSlots + (int)k + 1)) + "(%rbp)"; }
+
+    static bool isRegister(const string& loc) { return loc[0] == '%'; }
+
+    static bool fitsImmediate(const string& operand) {
+        long long v = stoll(operand);
+        return v >= INT32_MIN && v <= INT32_MAX;
+    }
+
+    // Location usable as a source operand; wide constants go through %r11
+    string source(Assembler& as, const string& operand) {
+        if (isConstant(operand) && !fitsImmediate(operand)) {
+            as.instruction("movabsq", {"$" + operand, "%r11"});
+            return "%r11";
+        }
+        return ra.location(operand);
+    }
+
+    void load(Assembler& as, const string& operand, const string& reg) {
+        string from = source(as, operand);
+        if (from != reg) as.instruction("movq", {from, reg});
+    }
+
+    void move(Assembler& as, const string& operand, const string& dst) {
+        string to = ra.location(dst), from = source(as, operand);
+        if (from == to) return;
+        if (!isRegister(from) && !isRegister(to) && from[0] != '$') {
+            as.instruction("movq", {from, "%rax"});
+            from = "%rax";
+        }
+        as.instruction("movq", {from, to});
+    }
+
+    // dst = a op b in two-address form, through %rax when dst is in memory or is b
+    void arithmetic(Assembler& as, const string& mnemonic, const Instr& in, bool commutative) {
+        string dst = ra.location(in.dst);
+        string b = isConstant(in.b) ? "" : ra.location(in.b);
+        if (isRegister(dst) && dst == b && commutative) {
+            as.instruction(mnemonic, {source(as, in.a), dst});
+        } else if (isRegister(dst) && dst != b) {
+            load(as, in.a, dst);
+            as.instruction(mnemonic, {source(as, in.b), dst});
+        } else {
+            load(as, in.a, "%rax");
+            as.instruction(mnemonic, {source(as, in.b), "%rax"});
+            as.instruction("movq", {"%rax", dst});
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// In-process JIT: machine code for AsmGenerator's output, run from an mmap'd buffer
+// ---------------------------------------------------------------------------
+
+// Encodes the instruction subset AsmGenerator emits straight to bytes.
+// Calls to runtime symbols become movabsq $address, %rax; call *%rax.
+class X86Encoder : public Assembler {
+public:
+    vector<uint8_t> code;
+
+    X86Encoder(const unordered_map<string, void*>& symbols) : symbols(symbols) {}
+
+    void label(const string& name) override { labels[name] = code.size(); }
+
+    void instruction(const string& m, const vector<string>& ops) override {
+        if (m == "movq") binary({0x89, 0x8B, 0xC7, 0}, ops);
+        else if (m == "addq") binary({0x01, 0x03, 0x81, 0}, ops);
+        else if (m == "subq") binary({0x29, 0x2B, 0x81, 5}, ops);
+        else if (m == "cmpq") binary({0x39, 0x3B, 0x81, 7}, ops);
+        else if (m == "imulq") multiply(ops);
+        else if (m == "movabsq") {
+            Operand dst = parse(ops[1]);
+            rex(0, dst.reg);
+            code.push_back(0xB8 + (dst.reg & 7));
+            put64(parse(ops[0]).imm);
+        } else if (m == "idivq") {
+            Operand src = parse(ops[0]);
+            rex(0, src.reg);
+            code.push_back(0xF7);
+            modrm(7, src);
+        } else if (m == "cqto") {
+            code.insert(code.end(), {0x48, 0x99});
+        } else if (m == "jmp" || m == "jge" || m == "jle" || m == "jne") {
+            if (m == "jmp") code.push_back(0xE9);
+            else code.insert(code.end(), {0x0F, (uint8_t)(m == "jge" ? 0x8D : m == "jle" ? 0x8E : 0x85)});
+            fixups.push_back({code.size(), ops[0]});
+            put32(0);
+        } else if (m == "call") {
+            code.insert(code.end(), {0x48, 0xB8});
+            put64((long long)(intptr_t)symbols.at(ops[0]));
+            code.insert(code.end(), {0xFF, 0xD0});
+        } else if (m == "pushq") {
+            code.push_back(0x55);  // only %rbp is ever pushed
+        } else if (m == "leave") {
+            code.push_back(0xC9);
+        } else if (m == "ret") {
+            code.push_back(0xC3);
+        } else if (m == "xorl") {
+            code.insert(code.end(), {0x31, 0xC0});  // only %eax, %eax
+        } else {
+            throw runtime_error("JIT: cannot encode " + m);
+        }
+    }
+
+    // Resolves jumps once every label is known
+    void finish() {
+        for (const auto& [at, target] : fixups) {
+            long long rel = (long long)labels.at(target) - (long long)(at + 4);
+            for (int k = 0; k < 4; k++) code[at + k] = (uint8_t)(rel >> (8 * k));
+        }
+        fixups.clear();
+    }
+
+private:
+    struct Operand {
+        char kind;      // 'r' register, 'm' disp(%rbp), 'i' immediate
+        int reg = 0;    // register number, %rbp for memory
+        long long imm = 0;  // immediate or displacement
+    };
+    struct Opcodes {
+        uint8_t regToRm, rmToReg, immediate, extension;
+    };
+
+    const unordered_map<string, void*>& symbols;
+    unordered_map<string, size_t> labels;
+    vector<pair<size_t, string>> fixups;  // rel32 position -> label
+
+    static int registerNumber(const string& name) {
+        static const unordered_map<string, int> numbers = {
+            {"%rax", 0}, {"%rcx", 1}, {"%rdx", 2}, {"%rbx", 3}, {"%rsp", 4}, {"%rbp", 5}, {"%rsi", 6}, {"%rdi", 7},
+            {"%r8", 8}, {"%r9", 9}, {"%r10", 10}, {"%r11", 11}, {"%r12", 12}, {"%r13", 13}, {"%r14", 14}, {"%r15", 15}};
+        return numbers.at(name);
+    }
+
+    static Operand parse(const string& text) {
+        Operand op;
+        if (text[0] == '$') {
+            op.kind = 'i';
+            op.imm = stoll(text.substr(1));
+        } else if (text[0] == '%') {
+            op.kind = 'r';
+            op.reg = registerNumber(text);
+        } else {
+            op.kind = 'm';
+            op.reg = 5;
+            op.imm = stoll(text.substr(0, text.find('(')));
+        }
+        return op;
+    }
+
+    void put32(long long v) {
+        for (int k = 0; k < 4; k++) code.push_back((uint8_t)(v >> (8 * k)));
+    }
+
+    void put64(long long v) {
+        for (int k = 0; k < 8; k++) code.push_back((uint8_t)(v >> (8 * k)));
+    }
+
+    void rex(int reg, int rm) {
+        code.push_back((uint8_t)(0x48 | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0)));
+    }
+
+    // ModRM (and displacement) for a register field and a register or %rbp-relative operand
+    void modrm(int reg, const Operand& rm) {
+        if (rm.kind == 'r') {
+            code.push_back((uint8_t)(0xC0 | ((reg & 7) << 3) | (rm.reg & 7)));
+        } else if (rm.imm >= -128 && rm.imm <= 127) {
+            code.push_back((uint8_t)(0x40 | ((reg & 7) << 3) | 5));
+            code.push_back((uint8_t)rm.imm);
+        } else {
+            code.push_back((uint8_t)(0x80 | ((reg & 7) << 3) | 5));
+            put32(rm.imm);
+        }
+    }
+
+    // op src, dst for mov/add/sub/cmp
+    void binary(const Opcodes& opcodes, const vector<string>& ops) {
+        Operand src = parse(ops[0]), dst = parse(ops[1]);
+        if (src.kind == 'i') {
+            rex(0, dst.reg);
+            code.push_back(opcodes.immediate);
+            modrm(opcodes.extension, dst);
+            put32(src.imm);
+        } else if (src.kind == 'r') {
+            rex(src.reg, dst.reg);
+            code.push_back(opcodes.regToRm);
+            modrm(src.reg, dst);
+        } else {
+            rex(dst.reg, src.reg);
+            code.push_back(opcodes.rmToReg);
+            modrm(dst.reg, src);
+        }
+    }
+
+    // imulq src, %reg
+    void multiply(const vector<string>& ops) {
+        Operand src = parse(ops[0]), dst = parse(ops[1]);
+        if (src.kind == 'i') {
+            rex(dst.reg, dst.reg);
+            code.push_back(0x69);
+            modrm(dst.reg, dst);
+            put32(src.imm);
+        } else {
+            rex(dst.reg, src.reg);
+            code.insert(code.end(), {0x0F, 0xAF});
+            modrm(dst.reg, src);
+        }
+    }
+};
+
+// Runtime entry points for JIT-compiled code; output is block-buffered like runtime.c
+namespace jitRuntime {
+    ostream* output = &cout;
+    string buffer;
+    // When the first Print ran, as output itself stays buffered until a flush
+    chrono::steady_clock::time_point firstPrint;
+    bool printed = false;
+
+    void flush() {
+        output->write(buffer.data(), (streamsize)buffer.size());
+        output->flush();
+        buffer.clear();
+    }
+
+    long long read() {
+        if (!buffer.empty()) flush();
+        long long value = 0;
+        cin >> value;
+        return value;
+    }
+
+    void print(long long value) {
+        if (!printed) firstPrint = chrono::steady_clock::now();
+        printed = true;
+        char digits[24];
+        auto [end, ec] = to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, end);
+        buffer.push_back('\n');
+        if (buffer.size() >= (1 << 16)) flush();
+    }
+}
+
+class JitCompiler {
+public:
+    using Entry = void (*)();
+
+    // Compile-latency and code-size counters of the last compile()
+    double allocateMs = 0, encodeMs = 0, mapMs = 0;
+    size_t codeBytes = 0;
+
+    ~JitCompiler() { release(); }
+
+    Entry compile(const IRProgram& ir, size_t registerLimit = 11) {
+        release();
+        auto t0 = chrono::steady_clock::now();
+        RegisterAllocator ra(ir, registerLimit);
+        ra.run();
+        auto t1 = chrono::steady_clock::now();
+        static const unordered_map<string, void*> symbols = {
+            {"simple_read", (void*)&jitRuntime::read},
+            {"simple_print", (void*)&jitRuntime::print},
+            {"simple_flush", (void*)&jitRuntime::flush}};
+        X86Encoder encoder(symbols);
+        AsmGenerator(ir, ra).generate(encoder, "entry");
+        encoder.finish();
+        auto t2 = chrono::steady_clock::now();
+
+        // Written while read-write, then flipped to read-execute before the call
+        codeBytes = encoder.code.size();
+        mappedBytes = codeBytes;
+        memory = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+            throw runtime_error("JIT: mmap failed");
+        }
+        memcpy(memory, encoder.code.data(), codeBytes);
+        if (mprotect(memory, mappedBytes, PROT_READ | PROT_EXEC) != 0) throw runtime_error("JIT: mprotect failed");
+        auto t3 = chrono::steady_clock::now();
+
+        allocateMs = chrono::duration<double, milli>(t1 - t0).count();
+        encodeMs = chrono::duration<double, milli>(t2 - t1).count();
+        mapMs = chrono::duration<double, milli>(t3 - t2).count();
+        return (Entry)memory;
+    }
+
+private:
+    void* memory = nullptr;
+    size_t mappedBytes = 0;
+
+    void release() {
+        if (memory) munmap(memory, mappedBytes);
+        memory = nullptr;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// IR interpreter with per-block execution counters
+// ---------------------------------------------------------------------------
+
+class Interpreter {
+public:
+    long long executed = 0;            // instructions executed, labels excluded
+    vector<long long> blockCount;      // executions of each block
+    vector<long long> instrsPerBlock;  // non-label instructions in each block
+
+    Interpreter(const IRProgram& ir, const CFG& cfg, ostream& out) : ir(ir), cfg(cfg), out(out) {}
+
+    void run() {
+        // Resolve names and constants to slots and labels to instruction indices up front
+        struct Compiled { IROp op; int dst, a, b; char relop; size_t target; int block; bool leader; };
+        const auto& code = ir.code;
+        vector<long long> mem;
+        unordered_map<string, int> slots;
+        auto slot = [&](const string& s) {
+            if (s.empty()) return -1;
+            auto it = slots.find(s);
+            if (it != slots.end()) return it->second;
+            mem.push_back(isConstant(s) ? stoll(s) : 0);
+            return slots[s] = (int)mem.size() - 1;
+        };
+        unordered_map<string, size_t> labelAt;
+        for (size_t i = 0; i < code.size(); i++)
+            if (code[i].op == IROp::Label) labelAt[code[i].label] = i;
+        vector<Compiled> program;
+        for (size_t i = 0; i < code.size(); i++) {
+            const Instr& in = code[i];
+            int block = cfg.blockOf[i];
+            program.push_back({in.op, slot(in.dst), slot(in.a), slot(in.b), in.relop.empty() ? '\0' : in.relop[0],
+                               in.isJump() ? labelAt.at(in.label) : 0, block, cfg.blocks[block].begin == i});
+        }
+
+        blockCount.assign(cfg.blocks.size(), 0);
+        instrsPerBlock.assign(cfg.blocks.size(), 0);
+        for (size_t b = 0; b < cfg.blocks.size(); b++)
+            for (size_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; i++)
+                if (code[i].op != IROp::Label) instrsPerBlock[b]++;
+
+        size_t pc = 0;
+        while (pc < program.size()) {
+            const Compiled& in = program[pc++];
+            if (in.leader) blockCount[in.block]++;
+            switch (in.op) {
+                case IROp::Label: break;
+                case IROp::Assign: mem[in.dst] = mem[in.a]; break;
+                case IROp::Add: mem[in.dst] = wrapAdd(mem[in.a], mem[in.b]); break;
+                case IROp::Sub: mem[in.dst] = wrapSub(mem[in.a], mem[in.b]); break;
+                case IROp::Mul: mem[in.dst] = wrapMul(mem[in.a], mem[in.b]); break;
+                case IROp::Div: mem[in.dst] = wrapDiv(mem[in.a], mem[in.b]); break;
+                case IROp::Goto: pc = in.target; break;
+                case IROp::IfFalse: {
+                    long long l = mem[in.a], r = mem[in.b];
+                    bool holds = in.relop == '<' ? l < r : in.relop == '>' ? l > r : l == r;
+                    if (!holds) pc = in.target;
+                    break;
+                }
+                case IROp::Read: {
+                    long long v = 0;
+                    cin >> v;
+                    mem[in.dst] = v;
+                    break;
+                }
+                case IROp::Print: out << mem[in.a] << "\n"; break;
+            }
+        }
+        for (size_t b = 0; b < cfg.blocks.size(); b++) executed += blockCount[b] * instrsPerBlock[b];
+    }
+
+private:
+    const IRProgram& ir;
+    const CFG& cfg;
+    ostream& out;
+};
+
+// Per-loop statistics of one run: loop header label -> (iterations, instructions per iteration)
+map<string, pair<long long, double>> loopProfile(const IRProgram& ir, const CFG& cfg, const Interpreter& run) {
+    map<string, pair<long long, double>> profile;
+    for (const Loop& loop : findLoops(cfg)) {
+        long long iterations = 0, instrs = 0;
+        for (int l : loop.latches) iterations += run.blockCount[l];
+        for (int b : loop.blocks) instrs += run.blockCount[b] * run.instrsPerBlock[b];
+        string name = ir.code[cfg.blocks[loop.header].begin].label;
+        profile[name] = {iterations, iterations ? (double)instrs / iterations : 0.0};
+    }
+    return profile;
+}
+
+// Random program in the README language for exercising the back end
+string generateProgram(int statements, unsigned seed) {
+    mt19937 rng(seed);
+    const int variables = 24;
+    auto pick = [&](int n) { return (int)(rng() % n); };
+    auto operand = [&]() { return pick(3) ? "v" + to_string(pick(variables)) : to_string(pick(100)); };
+    auto expr = [&]() {
+        string e = operand();
+        for (int terms = pick(5); terms > 0; terms--) e += (pick(2) ? " + " : " - ") + operand();
+        return e;
+    };
+    ostringstream src;
+    src << "Program\n";
+    for (int v = 0; v < variables; v++) src << "Var v" << v << ";\n";
+    int remaining = statements;
+    function<void(int)> statement = [&](int depth) {
+        remaining--;
+        int kind = depth < 3 ? pick(10) : pick(7);
+        if (kind < 5) {
+            src << "Put v" << pick(variables) << " = " << expr() << ";\n";
+        } else if (kind == 5) {
+            src << "Print (" << expr() << ");\n";
+        } else if (kind == 6) {
+            src << "Read (v" << pick(variables) << ");\n";
+        } else {
+            static const char* relops[] = {"<", ">", "=="};
+            src << (kind == 7 ? "Iteration" : "If") << " (" << expr() << " " << relops[pick(3)] << " " << expr()
+                << ") { Start\n";
+            for (int n = 1 + pick(6); n > 0 && remaining > 0; n--) statement(depth + 1);
+            src << "End }\n";
+        }
+    };
+    src << "Start\n";
+    while (remaining > 0) statement(0);
+    src << "End\nend\n";
+    return src.str();
+}
+
+// Times register allocation on generated programs of growing size
+void benchmarkRegisterAllocation() {
+    cout << "Instructions   Intervals   us/100k instr   Spills (11 regs)   Spills (4 regs)" << endl;
+    for (int statements : {3000, 30000, 100000}) {
+        IRProgram ir;
+        vector<Token> tokens = tokenize(generateProgram(statements, 42));
+        Parser parser(tokens);
+        BlockNode* program = parser.parseProgram(ir.variables);
+        program->generateIR(ir);
+        delete program;
+
+        auto t0 = chrono::steady_clock::now();
+        RegisterAllocator full(ir);
+        full.run();
+        auto t1 = chrono::steady_clock::now();
+        RegisterAllocator few(ir, 4);
+        few.run();
+        double us = chrono::duration<double, micro>(t1 - t0).count();
+        cout << ir.code.size() << "\t\t" << full.intervals.size() << "\t    " << us * 100000 / ir.code.size()
+             << "\t    " << full.spills << "\t\t       " << few.spills << endl;
+    }
+}
+
+struct Passes {
+    bool licm = false;
+    bool iv = false;
+};
+
+// Runs the selected optimizations; induction variables go last so that
+// loop bounds have already been hoisted into plain invariant operands
+void optimize(IRProgram& ir, const Passes& passes, ostream& log) {
+    if (passes.licm) log << "LICM: hoisted " << LICM(ir).run() << " instructions" << endl;
+    if (passes.iv) {
+        InductionVariables iv(ir);
+        iv.run();
+        log << "Induction variables: " << iv.closedForms << " loops in closed form, "
+            << iv.combined << " increments combined" << endl;
+    }
+}
+
+// Runs the program before and after optimization and reports dynamic instruction counts
+void benchmark(IRProgram& ir, const Passes& passes) {
+    ostringstream discard;
+    CFG before(ir.code);
+    Interpreter runBefore(ir, before, discard);
+    auto t0 = chrono::steady_clock::now();
+    runBefore.run();
+    auto t1 = chrono::steady_clock::now();
+    auto profileBefore = loopProfile(ir, before, runBefore);
+
+    optimize(ir, passes, cout);
+    CFG after(ir.code);
+    Interpreter runAfter(ir, after, discard);
+    auto t2 = chrono::steady_clock::now();
+    runAfter.run();
+    auto t3 = chrono::steady_clock::now();
+    auto profileAfter = loopProfile(ir, after, runAfter);
+
+    cout << "Loop      iterations before/after    instr/iter before/after" << endl;
+    for (const auto& [name, stats] : profileBefore) {
+        auto afterStats = profileAfter.count(name) ? profileAfter[name] : make_pair(0LL, 0.0);
+        cout << name << string(10 - min<size_t>(name.size(), 9), ' ') << stats.first << " / " << afterStats.first
+             << "\t\t" << stats.second << " / " << afterStats.second << endl;
+    }
+    cout << "Total executed: " << runBefore.executed << " -> " << runAfter.executed << endl;
+    cout << "Interpreter time (ms): "
+         << chrono::duration<double, milli>(t1 - t0).count() << " -> "
+         << chrono::duration<double, milli>(t3 - t2).count() << endl;
+}
+
+// Compiles the program to an executable: <exe>.s plus the runtime, built by the system cc
+bool buildNative(const IRProgram& ir, size_t registerLimit, const string& exe, const string& runtime) {
+    RegisterAllocator ra(ir, registerLimit);
+    ra.run();
+    ofstream asmFile(exe + ".s");
+    TextAssembler as(asmFile);
+    AsmGenerator(ir, ra).generate(as);
+    asmFile.close();
+    string command = "cc -O2 -o '" + exe + "' '" + exe + ".s' '" + runtime + "'";
+    return system(command.c_str()) == 0;
+}
+
+// Times the optimized program in the IR interpreter and as a native executable
+void benchmarkNative(IRProgram& ir, const string& runtime) {
+    optimize(ir, {true, true}, cout);
+
+    ostringstream interpreted;
+    CFG cfg(ir.code);
+    Interpreter interpreter(ir, cfg, interpreted);
+    auto t0 = chrono::steady_clock::now();
+    interpreter.run();
+    auto t1 = chrono::steady_clock::now();
+
+    string exe = "/tmp/simple_native_" + to_string(chrono::steady_clock::now().time_since_epoch().count());
+    if (!buildNative(ir, 11, exe, runtime)) {
+        cout << "Error: native build failed" << endl;
+        return;
+    }
+    auto t2 = chrono::steady_clock::now();
+    string native;
+    FILE* pipe = popen(exe.c_str(), "r");
+    char buffer[4096];
+    size_t n;
+    while (pipe && (n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) native.append(buffer, n);
+    if (pipe) pclose(pipe);
+    auto t3 = chrono::steady_clock::now();
+    remove(exe.c_str());
+    remove((exe + ".s").c_str());
+
+    double interpretedMs = chrono::duration<double, milli>(t1 - t0).count();
+    double buildMs = chrono::duration<double, milli>(t2 - t1).count();
+    double nativeMs = chrono::duration<double, milli>(t3 - t2).count();
+    cout << "Interpreter: " << interpretedMs << " ms (" << interpreter.executed << " instructions)" << endl;
+    cout << "Native: " << nativeMs << " ms, plus " << buildMs << " ms to assemble and link" << endl;
+    cout << "Speedup: " << interpretedMs / nativeMs << "x, output "
+         << (native == interpreted.str() ? "matches" : "DIFFERS") << endl;
+}
+
+// Stream buffer that keeps what is written and remembers when the first byte arrived
+class FirstOutputClock : public streambuf {
+public:
+    chrono::steady_clock::time_point first;
+    bool written = false;
+    string text;
+
+protected:
+    int overflow(int c) override {
+        mark();
+        if (c != EOF) text.push_back((char)c);
+        return c;
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        mark();
+        text.append(s, (size_t)n);
+        return n;
+    }
+
+private:
+    void mark() {
+        if (!written) first = chrono::steady_clock::now();
+        written = true;
+    }
+};
+
+// Source text to optimized IR, as every execution mode starts
+IRProgram compileSource(const string& source) {
+    IRProgram ir;
+    vector<Token> tokens = tokenize(source);
+    Parser parser(tokens);
+    BlockNode* program = parser.parseProgram(ir.variables);
+    program->generateIR(ir);
+    delete program;
+    ostringstream quiet;
+    optimize(ir, {true, true}, quiet);
+    return ir;
+}
+
+// Startup-to-first-output latency and loop throughput of the interpreter,
+// the in-process JIT and the cc-built executable
+void benchmarkJit(const string& source, const string& runtime) {
+    using clock = chrono::steady_clock;
+    auto ms = [](clock::time_point a, clock::time_point b) { return chrono::duration<double, milli>(b - a).count(); };
+
+    FirstOutputClock interpreted;
+    ostream interpretedOut(&interpreted);
+    auto t0 = clock::now();
+    IRProgram ir = compileSource(source);
+    CFG cfg(ir.code);
+    Interpreter interpreter(ir, cfg, interpretedOut);
+    auto ready = clock::now();
+    interpreter.run();
+    auto t1 = clock::now();
+    double interpreterFirst = ms(t0, interpreted.first), interpreterTotal = ms(t0, t1), interpreterRun = ms(ready, t1);
+
+    FirstOutputClock jitted;
+    ostream jittedOut(&jitted);
+    jitRuntime::output = &jittedOut;
+    JitCompiler jit;
+    jitRuntime::printed = false;
+    t0 = clock::now();
+    JitCompiler::Entry entry = jit.compile(compileSource(source));
+    ready = clock::now();
+    entry();
+    t1 = clock::now();
+    double jitFirst = ms(t0, jitRuntime::firstPrint), jitTotal = ms(t0, t1), jitRun = ms(ready, t1);
+    string jitOutput = jitted.text;
+    // Steady state: run the already compiled code again
+    ready = clock::now();
+    entry();
+    double jitWarm = ms(ready, clock::now());
+    jitRuntime::output = &cout;
+
+    string exe = "/tmp/simple_jit_bench_" + to_string(clock::now().time_since_epoch().count());
+    t0 = clock::now();
+    bool built = buildNative(compileSource(source), 11, exe, runtime);
+    FILE* pipe = built ? popen(exe.c_str(), "r") : nullptr;
+    auto nativeFirst = t0;
+    string native;
+    char buffer[4096];
+    size_t n;
+    while (pipe && (n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        if (native.empty()) nativeFirst = clock::now();
+        native.append(buffer, n);
+    }
+    if (pipe) pclose(pipe);
+    t1 = clock::now();
+    remove(exe.c_str());
+    remove((exe + ".s").c_str());
+
+    // The JIT's first output is timed at the first Print call; the others when bytes arrive
+    cout << "Mode          first output (ms)   total (ms)   run (ms)" << endl;
+    cout << "interpreter   " << interpreterFirst << "\t\t   " << interpreterTotal << "\t" << interpreterRun << endl;
+    cout << "jit           " << jitFirst << "\t\t   " << jitTotal << "\t" << jitRun << " (warm " << jitWarm << ")" << endl;
+    if (built) cout << "native (cc)   " << ms(t0, nativeFirst) << "\t\t   " << ms(t0, t1) << endl;
+    cout << "JIT compile: " << jit.allocateMs << " ms allocate, " << jit.encodeMs << " ms encode, "
+         << jit.mapMs << " ms map, " << jit.codeBytes << " bytes of code" << endl;
+    cout << "Throughput (M IR instructions/s): interpreter " << interpreter.executed / interpreterRun / 1e3
+         << ", JIT " << interpreter.executed / jitWarm / 1e3 << endl;
+    bool same = jitOutput == interpreted.text && jitted.text == jitOutput + jitOutput &&
+                (!built || native == interpreted.text);
+    cout << "Output " << (same ? "matches" : "DIFFERS") << endl;
+}
+
+// Printed after a bad command line
+const char* const usage =
+    "Usage: ir [source file] [--licm] [--iv] [--regs N] [--runtime runtime.c]\n"
+    "          [--run | --jit | --bench | --regalloc | --asm out.s | --native out\n"
+    "           | --bench-native | --bench-jit]\n"
+    "       ir --bench-regalloc\n";
+
+int main(int argc, char* argv[]) {
+    string path = "input.txt";
+    Passes passes;
+    bool bench = false, run = false, regalloc = false, benchNative = false, jit = false, benchJit = false;
+    size_t registerLimit = 11;
+    string asmPath, exePath, runtime = "runtime.c";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--licm") passes.licm = true;
+        else if (arg == "--iv") passes.iv = true;
+        else if (arg == "--bench") bench = true;
+        else if (arg == "--run") run = true;
+        else if (arg == "--regalloc") regalloc = true;
+        else if (arg == "--regs") {
+            bool valid = false;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                try {
+                    size_t used = 0;
+                    registerLimit = stoul(argv[i + 1], &used);
+                    valid = argv[i + 1][used] == '\0';
+                } catch (const exception&) {
+                }
+            }
+            if (!valid) {
+                cout << "Error: --regs needs a register count" << endl << usage;
+                return 1;
+            }
+            i++;
+        }
+        else if (arg == "--asm" && i + 1 < argc) asmPath = argv[++i];
+        else if (arg == "--native" && i + 1 < argc) exePath = argv[++i];
+        else if (arg == "--runtime" && i + 1 < argc) runtime = argv[++i];
+        else if (arg == "--bench-native") benchNative = true;
+        else if (arg == "--jit") jit = true;
+        else if (arg == "--bench-jit") benchJit = true;
+        else if (arg == "--bench-regalloc") {
+            benchmarkRegisterAllocation();
+            return 0;
+        }
+        else path = arg;
+    }
+
+    ifstream file(path);
+    if (!file) {
+        cout << "Error opening file!" << endl;
+        return 1;
+    }
+    string code((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    IRProgram ir;
+    try {
+        vector<Token> tokens = tokenize(code);
+        Parser parser(tokens);
+        BlockNode* program = parser.parseProgram(ir.variables);
+        program->generateIR(ir);
+        delete program;
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    if (bench) {
+        // Without explicit passes, measure everything
+        if (!passes.licm && !passes.iv) passes.licm = passes.iv = true;
+        benchmark(ir, passes);
+        return 0;
+    }
+    if (benchJit) {
+        benchmarkJit(code, runtime);
+        return 0;
+    }
+    if (benchNative) {
+        benchmarkNative(ir, runtime);
+        return 0;
+    }
+    optimize(ir, passes, run || jit ? cerr : cout);
+
+    if (!asmPath.empty()) {
+        RegisterAllocator ra(ir, registerLimit);
+        ra.run();
+        ofstream out(asmPath);
+        TextAssembler as(out);
+        AsmGenerator(ir, ra).generate(as);
+        return 0;
+    }
+    if (!exePath.empty()) return buildNative(ir, registerLimit, exePath, runtime) ? 0 : 1;
+
+    if (jit) {
+        JitCompiler compiler;
+        auto t0 = chrono::steady_clock::now();
+        JitCompiler::Entry entry = compiler.compile(ir, registerLimit);
+        auto t1 = chrono::steady_clock::now();
+        entry();
+        auto t2 = chrono::steady_clock::now();
+        cerr << "Compiled " << compiler.codeBytes << " bytes in " << chrono::duration<double, milli>(t1 - t0).count()
+             << " ms (allocate " << compiler.allocateMs << ", encode " << compiler.encodeMs << ", map "
+             << compiler.mapMs << "), ran in " << chrono::duration<double, milli>(t2 - t1).count() << " ms" << endl;
+        return 0;
+    }
+    if (run) {
+        CFG cfg(ir.code);
+        Interpreter interpreter(ir, cfg, cout);
+        auto t0 = chrono::steady_clock::now();
+        interpreter.run();
+        auto t1 = chrono::steady_clock::now();
+        cerr << "Executed " << interpreter.executed << " instructions in "
+             << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+        return 0;
+    }
+
+    if (regalloc) {
+        RegisterAllocator ra(ir, registerLimit);
+        ra.run();
+        cout << "Live intervals:" << endl;
+        ra.print(cout);
+        cout << "Allocated IR:" << endl;
+        printAllocated(ir, ra, cout);
+        return 0;
+    }
+
+    cout << "Intermediate Representation (IR):" << endl;
+    ir.print(cout);
     return 0;
 }
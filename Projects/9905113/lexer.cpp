@@ -2,74 +2,74 @@
 #include <fstream>
 #include <vector>
 #include <cctype>
+#include <chrono>
+#include <iomanip>
 #include <unordered_set>
+#include "token_stream.h"
 
 using namespace std;
 
 // List of keywords
-unordered_set<string> keywords = {"Program", "Var", "Start", "End", "If", "Iteration", "Print", "Read", "Put"};
+unordered_set<string_view> keywords = {"Program", "Var", "Start", "End", "If", "Iteration", "Print", "Read", "Put", "end"};
 
 class Lexer {
 private:
-    string input;
+    const string& input;
     size_t pos = 0;
-    
+
     // Function to get the next character from the input string
     char getNextChar() {
         return pos < input.size() ? input[pos++] : '\0';
     }
-    
-    // Function to unread the last character
-    void unreadChar() {
-        if (pos > 0) pos--;
+
+    // Function to unread the last character (nothing was read at the end)
+    void unreadChar(char c) {
+        if (c != '\0' && pos > 0) pos--;
+    }
+
+    string_view lexeme(size_t start) const {
+        return string_view(input).substr(start, pos - start);
     }
-    
+
 public:
+    // Tokens point into input, which must outlive them
     Lexer(const string& input) : input(input) {}
 
     // Tokenization function to process the input string
-    vector<string> tokenize() {
-        vector<string> tokens;
+    vector<Token> tokenize() {
+        vector<Token> tokens;
         char c;
-        
+
         while ((c = getNextChar()) != '\0') {
             // Skip whitespaces
             if (isspace(c)) continue;
+            size_t start = pos - 1;
 
             // Identify keywords and identifiers
             if (isalpha(c)) {
-                string token;
-                token += c;
                 while (isalnum(c = getNextChar())) {
-                    token += c;
                 }
-                unreadChar(); // Unread the last character
+                unreadChar(c); // Unread the last character
 
                 // Check if the token is a keyword or an identifier
-                if (keywords.count(token)) {
-                    tokens.push_back("Keyword: " + token);
-                } else {
-                    tokens.push_back("Identifier: " + token);
-                }
+                string_view token = lexeme(start);
+                tokens.push_back({keywords.count(token) ? KEYWORD : IDENTIFIER, token, start});
                 continue;
             }
 
             // Identify integers
             if (isdigit(c)) {
-                string number;
-                number += c;
                 while (isdigit(c = getNextChar())) {
-                    number += c;
                 }
-                unreadChar();
-                tokens.push_back("Integer: " + number);
+                unreadChar(c);
+                tokens.push_back({INTEGER, lexeme(start), start});
                 continue;
             }
 
             // Identify operators and symbols
             switch (c) {
                 case '+': case '-': case '=': case '<': case '>': case ';': case '(': case ')': case '{': case '}':
-                    tokens.push_back("Symbol: " + string(1, c));
+                    tokens.push_back({SYMBOL, lexeme(start), start});
                     break;
                 default:
                     cout << "Unknown error: " << c << endl;
@@ -79,8 +79,74 @@ public:
     }
 };
 
-int main() {
-    ifstream file("input.txt"); // Input file containing the code
+// The two ways tokens leave this stage: the text lines, or the binary stream
+string textFormat(const vector<Token>& tokens) {
+    string out;
+    for (const auto& token : tokens) {
+        out += categoryNames[token.category];
+        out += ": ";
+        out += token.text;
+        out += '\n';
+    }
+    return out;
+}
+
+string binaryFormat(const vector<Token>& tokens) {
+    string out;
+    TokenStreamWriter writer(out);
+    for (const auto& token : tokens) {
+        writer.write(token);
+    }
+    writer.finish();
+    return out;
+}
+
+// Lexes a generated source of about megabytes MB and writes both formats:
+// bench_tokens.txt and bench_tokens.bin, for `parser --bench`. The first
+// source repeats the program parser.cpp accepts; the second has many
+// distinct identifiers and numbers, to show what interning costs.
+void benchmark(size_t megabytes) {
+    string accepted, varied;
+    while (accepted.size() < (megabytes << 20)) {
+        accepted += "Program Var x;\nStart Print(x);\nEnd end\n";
+    }
+    for (size_t i = 0; varied.size() < (megabytes << 20); i++) {
+        varied += "Put total" + to_string(i % 5000) + " = count" + to_string(i % 300) + " + " + to_string(i % 1000) + ";\n";
+    }
+
+    for (auto [name, source] : {make_pair("parser's program", &accepted), make_pair("5000 identifiers", &varied)}) {
+        cout << name << ", " << source->size() / double(1 << 20) << " MB of source\n";
+        for (bool binary : {false, true}) {
+            auto start = chrono::steady_clock::now();
+            Lexer lexer(*source);
+            vector<Token> tokens = lexer.tokenize();
+            string out = binary ? binaryFormat(tokens) : textFormat(tokens);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "  " << left << setw(8) << (binary ? "binary" : "text") << right << fixed << setprecision(2)
+                 << setw(8) << double(out.size()) / tokens.size() << " bytes/token" << setw(10)
+                 << out.size() / double(1 << 20) << " MB" << setw(9) << setprecision(1)
+                 << source->size() / seconds / 1e6 << " MB/s of source (lex + encode)\n";
+            if (source == &accepted) {
+                ofstream(binary ? "bench_tokens.bin" : "bench_tokens.txt", ios::binary) << out;
+            }
+        }
+    }
+    cout << "Wrote bench_tokens.txt and bench_tokens.bin\n";
+}
+
+int main(int argc, char* argv[]) {
+    string path = "input.txt", binaryPath;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--bench") {
+            benchmark(i + 1 < argc ? stoul(argv[i + 1]) : 64);
+            return 0;
+        }
+        else if (arg == "-o" && i + 1 < argc) binaryPath = argv[++i];
+        else path = arg;
+    }
+
+    ifstream file(path); // Input file containing the code
     if (!file) {
         cout << "Error opening file!" << endl;
         return 1;
@@ -88,12 +154,21 @@ int main() {
 
     string code((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
     Lexer lexer(code);
-    
-    vector<string> tokens = lexer.tokenize();
-    
-    for (const auto& token : tokens) {
-        cout << token << endl;
+
+    vector<Token> tokens = lexer.tokenize();
+
+    // With -o, the tokens go to the parser stage as a binary stream
+    if (!binaryPath.empty()) {
+        ofstream out(binaryPath, ios::binary);
+        out << binaryFormat(tokens);
+        if (!out) {
+            cout << "Error writing " << binaryPath << endl;
+            return 1;
+        }
+        return 0;
     }
 
+    cout << textFormat(tokens);
+
     return 0;
 }
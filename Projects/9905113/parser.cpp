@@ -1,92 +1,220 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <string>
+#include <chrono>
+#include <iomanip>
+#include "token_stream.h"
 
 using namespace std;
 
-vector<string> tokens; // List of tokens
-int currentTokenIndex = 0; // Current token index
+// A token the grammar expects, in the terms of both formats
+struct Expected {
+    TokenCategory category;
+    string_view text;
+    string line; // "Keyword: Program"
+};
 
-// Function to get the current token
-string getCurrentToken() {
-    if (currentTokenIndex < tokens.size()) {
-        return tokens[currentTokenIndex];
-    }
-    return ""; // Return an empty string if no more tokens
+Expected expected(TokenCategory category, string_view text) {
+    return {category, text, string(categoryNames[category]) + ": " + string(text)};
 }
 
-// Function to move to the next token
-void advanceToken() {
-    if (currentTokenIndex < tokens.size()) {
-        currentTokenIndex++;
-    }
-}
+const Expected PROGRAM = expected(KEYWORD, "Program"), VAR = expected(KEYWORD, "Var"),
+               START = expected(KEYWORD, "Start"), PRINT = expected(KEYWORD, "Print"),
+               END = expected(KEYWORD, "End"), PROGRAM_END = expected(KEYWORD, "end"),
+               X = expected(IDENTIFIER, "x"), SEMICOLON = expected(SYMBOL, ";"),
+               LPAREN = expected(SYMBOL, "("), RPAREN = expected(SYMBOL, ")");
 
-// Function to match the expected token with the current token
-bool match(string expected) {
-    if (getCurrentToken() == expected) {
-        advanceToken();
-        return true;
-    } else {
-        cout << "Error: Expected '" << expected << "' but found '" << getCurrentToken() << "'" << endl;
-        return false;
-    }
-}
+// Tokens in the lexer's text format, one "Keyword: Program" line each
+struct TextTokens {
+    vector<string> lines;
 
-// Function to parse the program
-bool parseProgram() {
-    cout << "Parsing Program..." << endl;
+    size_t size() const { return lines.size(); }
+    bool matches(size_t i, const Expected& token) const { return lines[i] == token.line; }
+    string describe(size_t i) const { return lines[i]; }
+};
 
-    if (!match("Keyword: Program")) { // Program should start with 'Program'
-        return false;
-    }
-    if (!match("Keyword: Var")) { // Must have a 'Var' section
-        return false;
-    }
-    if (!match("Identifier: x")) { // There must be an identifier, like 'x'
-        return false;
-    }
-    if (!match("Symbol: ;")) { // Semicolon after variable declaration
-        return false;
-    }
-    if (!match("Keyword: Start")) { // 'Start' keyword to begin the block
-        return false;
-    }
-    if (!match("Keyword: Print")) { // Print keyword should be present
-        return false;
+// Tokens decoded from the binary token stream
+struct StreamTokens {
+    vector<Token> tokens;
+
+    size_t size() const { return tokens.size(); }
+    bool matches(size_t i, const Expected& token) const {
+        return tokens[i].category == token.category && tokens[i].text == token.text;
     }
-    if (!match("Symbol: (")) { // Opening parenthesis for the print statement
-        return false;
+    string describe(size_t i) const { return ::describe(tokens[i]); }
+};
+
+template <typename Tokens>
+class Parser {
+public:
+    Parser(const Tokens& tokens, ostream& out = cout) : tokens(tokens), out(out) {}
+
+    bool atEnd() const {
+        return currentTokenIndex >= tokens.size();
     }
-    if (!match("Identifier: x")) { // 'x' should be printed
-        return false;
+
+    // Function to parse the program
+    bool parseProgram() {
+        out << "Parsing Program..." << '\n';
+
+        if (!match(PROGRAM)) { // Program should start with 'Program'
+            return false;
+        }
+        if (!match(VAR)) { // Must have a 'Var' section
+            return false;
+        }
+        if (!match(X)) { // There must be an identifier, like 'x'
+            return false;
+        }
+        if (!match(SEMICOLON)) { // Semicolon after variable declaration
+            return false;
+        }
+        if (!match(START)) { // 'Start' keyword to begin the block
+            return false;
+        }
+        if (!match(PRINT)) { // Print keyword should be present
+            return false;
+        }
+        if (!match(LPAREN)) { // Opening parenthesis for the print statement
+            return false;
+        }
+        if (!match(X)) { // 'x' should be printed
+            return false;
+        }
+        if (!match(RPAREN)) { // Closing parenthesis for the print statement
+            return false;
+        }
+        if (!match(SEMICOLON)) { // Semicolon after the print statement
+            return false;
+        }
+        if (!match(END)) { // 'End' keyword should be present to close the block
+            return false;
+        }
+        if (!match(PROGRAM_END)) { // The program should end with 'end'
+            return false;
+        }
+
+        return true; // Program parsed successfully
     }
-    if (!match("Symbol: )")) { // Closing parenthesis for the print statement
-        return false;
+
+private:
+    const Tokens& tokens;
+    size_t currentTokenIndex = 0; // Current token index
+    ostream& out;
+
+    // Function to get the current token
+    string getCurrentToken() {
+        if (currentTokenIndex < tokens.size()) {
+            return tokens.describe(currentTokenIndex);
+        }
+        return ""; // Return an empty string if no more tokens
     }
-    if (!match("Symbol: ;")) { // Semicolon after the print statement
-        return false;
+
+    // Function to move to the next token
+    void advanceToken() {
+        if (currentTokenIndex < tokens.size()) {
+            currentTokenIndex++;
+        }
     }
-    if (!match("Keyword: End")) { // 'End' keyword should be present to close the block
-        return false;
+
+    // Function to match the expected token with the current token
+    bool match(const Expected& expected) {
+        if (currentTokenIndex < tokens.size() && tokens.matches(currentTokenIndex, expected)) {
+            advanceToken();
+            return true;
+        } else {
+            out << "Error: Expected '" << expected.line << "' but found '" << getCurrentToken() << "'" << endl;
+            return false;
+        }
+    }
+};
+
+// A stream may hold several programs one after another
+template <typename Tokens>
+bool parseAll(const Tokens& tokens, ostream& out = cout) {
+    Parser<Tokens> parser(tokens, out);
+    do {
+        if (!parser.parseProgram()) {
+            return false;
+        }
+    } while (!parser.atEnd());
+    return true;
+}
+
+TextTokens readText(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        throw runtime_error("cannot open " + path);
     }
-    if (!match("Keyword: end")) { // The program should end with 'end'
-        return false;
+    TextTokens tokens;
+    for (string line; getline(file, line);) {
+        tokens.lines.push_back(line);
     }
-
-    return true; // Program parsed successfully
+    return tokens;
 }
 
-int main() {
-    // Simulating the output from the lexer
-    tokens = {
-        "Keyword: Program", "Keyword: Var", "Identifier: x", "Symbol: ;",
-        "Keyword: Start", "Keyword: Print", "Symbol: (", "Identifier: x", "Symbol: )",
-        "Symbol: ;", "Keyword: End", "Keyword: end"
+// Reading and parsing the two files `lexer --bench` writes, best of rounds
+void benchmark(const string& textPath, const string& binaryPath, int rounds) {
+    ostream nowhere(nullptr);
+    auto run = [&](const char* name, const string& path, auto parse) {
+        double best = 1e30;
+        size_t count = 0;
+        bool accepted = false;
+        for (int round = 0; round < rounds; round++) {
+            auto start = chrono::steady_clock::now();
+            tie(count, accepted) = parse();
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        ifstream file(path, ios::binary | ios::ate);
+        double bytes = static_cast<double>(file.tellg());
+        cout << left << setw(8) << name << right << fixed << setprecision(2) << setw(8) << bytes / count
+             << " bytes/token" << setw(9) << setprecision(1) << count / best / 1e6 << " M tokens/s"
+             << setw(9) << best * 1e3 << " ms (read + parse)" << (accepted ? "" : "  REJECTED") << "\n";
     };
+    run("text", textPath, [&] {
+        TextTokens tokens = readText(textPath);
+        return make_pair(tokens.size(), parseAll(tokens, nowhere));
+    });
+    run("binary", binaryPath, [&] {
+        TokenStreamReader reader(binaryPath);
+        StreamTokens tokens{reader.readAll()};
+        return make_pair(tokens.size(), parseAll(tokens, nowhere));
+    });
+}
+
+int main(int argc, char* argv[]) {
+    bool result;
+    try {
+        if (argc >= 4 && string(argv[1]) == "--bench") {
+            benchmark(argv[2], argv[3], argc > 4 ? stoi(argv[4]) : 3);
+            return 0;
+        }
+        if (argc == 3 && string(argv[1]) == "--text") {
+            // Tokens as the lexer prints them
+            result = parseAll(readText(argv[2]));
+        }
+        else if (argc == 2) {
+            // A binary token stream written by `lexer -o`
+            TokenStreamReader reader(argv[1]);
+            result = parseAll(StreamTokens{reader.readAll()});
+        }
+        else {
+            // Simulating the output from the lexer
+            TextTokens tokens{{
+                "Keyword: Program", "Keyword: Var", "Identifier: x", "Symbol: ;",
+                "Keyword: Start", "Keyword: Print", "Symbol: (", "Identifier: x", "Symbol: )",
+                "Symbol: ;", "Keyword: End", "Keyword: end"
+            }};
+            result = parseAll(tokens);
+        }
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
 
     // Parsing the program
-    if (parseProgram()) {
+    if (result) {
         cout << "The program is syntactically correct." << endl;
     } else {
         cout << "Syntactic error in the program!" << endl;
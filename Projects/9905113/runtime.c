@@ -0,0 +1,37 @@
+#include <stdio.h>
+
+/* I/O runtime linked into programs compiled by "ir --native" */
+
+static char output[1 << 16];
+static size_t outputLength = 0;
+
+/* Writes out everything printed so far */
+void simple_flush(void) {
+    fwrite(output, 1, outputLength, stdout);
+    fflush(stdout);
+    outputLength = 0;
+}
+
+/* Read ( x ) ; -- a missing or malformed number reads as 0 */
+long long simple_read(void) {
+    long long value = 0;
+    /* Pending output goes first so prompts appear before input is awaited */
+    if (outputLength > 0) simple_flush();
+    if (scanf("%lld", &value) != 1) value = 0;
+    return value;
+}
+
+/* Print ( <EXPR> ) ; -- one number per line */
+void simple_print(long long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    if (outputLength + sizeof(digits) > sizeof(output)) simple_flush();
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) output[outputLength++] = '-';
+    while (n > 0) output[outputLength++] = digits[--n];
+    output[outputLength++] = '\n';
+}
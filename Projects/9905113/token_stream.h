@@ -0,0 +1,250 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+// Binary token stream passed from lexer.cpp to parser.cpp, in place of the
+// "Keyword: Program" lines. Version 1 layout:
+//
+//   header    'T' 'K' 'S' <version byte>
+//   token     <kind byte> <varint gap> [payload]
+//   end       <kind END>  <varint number of tokens>
+//
+// Varints are unsigned LEB128. The gap is the number of source bytes
+// between the end of the previous token and the start of this one, so a
+// reader can recover every token's offset for diagnostics. Keywords and
+// symbols have a kind byte each and no payload. Identifiers and integers
+// are interned: the first occurrence of a lexeme is written out in full
+// (NEW_IDENTIFIER / NEW_INTEGER, varint length and bytes) and takes the
+// next id; later occurrences are IDENTIFIER / INTEGER with a varint id.
+// A lexer can therefore write as it goes, and a parser can decode straight
+// from an mmap'd file, its lexemes pointing into the mapping.
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint8_t TOKEN_STREAM_VERSION = 1;
+
+enum TokenCategory { KEYWORD, IDENTIFIER, INTEGER, SYMBOL };
+
+const char* const categoryNames[] = {"Keyword", "Identifier", "Integer", "Symbol"};
+
+// Kind bytes: 0x01 + keyword index, 0x20 + symbol index
+enum TokenKind : uint8_t {
+    KIND_END = 0x00,
+    KIND_KEYWORD = 0x01,
+    KIND_IDENTIFIER = 0x10,
+    KIND_NEW_IDENTIFIER = 0x11,
+    KIND_INTEGER = 0x12,
+    KIND_NEW_INTEGER = 0x13,
+    KIND_SYMBOL = 0x20
+};
+
+const std::string_view streamKeywords[] = {"Program", "Var", "Start", "End", "If", "Iteration", "Print", "Read", "Put", "end"};
+const size_t streamKeywordCount = sizeof(streamKeywords) / sizeof(streamKeywords[0]);
+const std::string_view streamSymbols = "+-=<>;(){}";
+
+struct Token {
+    TokenCategory category;
+    std::string_view text;
+    size_t offset;  // in the source file
+};
+
+// "Keyword: Program", the lexer's text format
+inline std::string describe(const Token& token) {
+    return std::string(categoryNames[token.category]) + ": " + std::string(token.text);
+}
+
+// Appends one token at a time to a byte buffer. Lexemes are interned by
+// content, so the views passed in only need to live as long as the writer.
+class TokenStreamWriter {
+public:
+    explicit TokenStreamWriter(std::string& out) : out(out) {
+        out += "TKS";
+        out += static_cast<char>(TOKEN_STREAM_VERSION);
+    }
+
+    void write(const Token& token) {
+        uint8_t kind = KIND_END;
+        if (token.category == KEYWORD) {
+            for (size_t i = 0; i < streamKeywordCount && kind == KIND_END; i++) {
+                if (streamKeywords[i] == token.text) kind = static_cast<uint8_t>(KIND_KEYWORD + i);
+            }
+        } else if (token.category == SYMBOL) {
+            size_t i = token.text.size() == 1 ? streamSymbols.find(token.text[0]) : std::string_view::npos;
+            if (i != std::string_view::npos) kind = static_cast<uint8_t>(KIND_SYMBOL + i);
+        } else {
+            auto& ids = token.category == IDENTIFIER ? identifiers : integers;
+            auto [it, added] = ids.emplace(token.text, static_cast<uint32_t>(ids.size()));
+            kind = token.category == IDENTIFIER ? (added ? KIND_NEW_IDENTIFIER : KIND_IDENTIFIER)
+                                                : (added ? KIND_NEW_INTEGER : KIND_INTEGER);
+            out += static_cast<char>(kind);
+            varint(token.offset - end);
+            if (added) {
+                varint(token.text.size());
+                out += token.text;
+            } else {
+                varint(it->second);
+            }
+            end = token.offset + token.text.size();
+            count++;
+            return;
+        }
+        if (kind == KIND_END) {
+            throw std::runtime_error("token stream: no kind for " + describe(token));
+        }
+        out += static_cast<char>(kind);
+        varint(token.offset - end);
+        end = token.offset + token.text.size();
+        count++;
+    }
+
+    void finish() {
+        out += static_cast<char>(KIND_END);
+        varint(count);
+    }
+
+private:
+    std::string& out;
+    // Keys view the caller's lexemes; ids count from 0 per category
+    std::unordered_map<std::string_view, uint32_t> identifiers, integers;
+    size_t end = 0;
+    size_t count = 0;
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+};
+
+// Maps a token stream file read-only and decodes it. Lexemes of decoded
+// tokens point into the mapping, or into the static tables above, and
+// stay valid while the reader lives.
+class TokenStreamReader {
+public:
+    explicit TokenStreamReader(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("token stream: cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < 4) {
+            close(fd);
+            throw std::runtime_error("token stream: " + path + " is too short");
+        }
+        size = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("token stream: cannot map " + path);
+        }
+        data = static_cast<const uint8_t*>(mapped);
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        // The destructor will not run if the constructor throws
+        std::string problem;
+        if (memcmp(data, "TKS", 3) != 0) {
+            problem = path + " is not a token stream";
+        } else if (data[3] != TOKEN_STREAM_VERSION) {
+            problem = path + " has version " + std::to_string(data[3]) +
+                      ", this reader supports " + std::to_string(TOKEN_STREAM_VERSION);
+        }
+        if (!problem.empty()) {
+            munmap(mapped, size);
+            throw std::runtime_error("token stream: " + problem);
+        }
+    }
+
+    ~TokenStreamReader() {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    TokenStreamReader(const TokenStreamReader&) = delete;
+    TokenStreamReader& operator=(const TokenStreamReader&) = delete;
+
+    std::vector<Token> readAll() {
+        std::vector<Token> tokens;
+        std::vector<std::string_view> identifiers, integers;
+        size_t pos = 4, end = 0;
+        while (true) {
+            uint8_t kind = byte(pos);
+            if (kind == KIND_END) {
+                if (varint(pos) != tokens.size()) {
+                    throw std::runtime_error("token stream: token count does not match");
+                }
+                return tokens;
+            }
+            Token token;
+            token.offset = end + varint(pos);
+            if (kind >= KIND_KEYWORD && kind < KIND_KEYWORD + streamKeywordCount) {
+                token.category = KEYWORD;
+                token.text = streamKeywords[kind - KIND_KEYWORD];
+            } else if (kind >= KIND_SYMBOL && kind < KIND_SYMBOL + streamSymbols.size()) {
+                token.category = SYMBOL;
+                token.text = streamSymbols.substr(kind - KIND_SYMBOL, 1);
+            } else if (kind >= KIND_IDENTIFIER && kind <= KIND_NEW_INTEGER) {
+                bool identifier = kind == KIND_IDENTIFIER || kind == KIND_NEW_IDENTIFIER;
+                std::vector<std::string_view>& table = identifier ? identifiers : integers;
+                token.category = identifier ? IDENTIFIER : INTEGER;
+                if (kind == KIND_NEW_IDENTIFIER || kind == KIND_NEW_INTEGER) {
+                    uint64_t length = varint(pos);
+                    if (length > size - pos) {
+                        throw std::runtime_error("token stream: lexeme runs past the end");
+                    }
+                    table.emplace_back(reinterpret_cast<const char*>(data + pos), length);
+                    pos += length;
+                    token.text = table.back();
+                }
+                else {
+                    uint64_t id = varint(pos);
+                    if (id >= table.size()) {
+                        throw std::runtime_error("token stream: unknown lexeme id " + std::to_string(id));
+                    }
+                    token.text = table[id];
+                }
+            } else {
+                throw std::runtime_error("token stream: bad kind byte " + std::to_string(kind));
+            }
+            end = token.offset + token.text.size();
+            tokens.push_back(token);
+        }
+    }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    uint8_t byte(size_t& pos) {
+        if (pos >= size) {
+            throw std::runtime_error("token stream: truncated");
+        }
+        return data[pos++];
+    }
+
+    uint64_t varint(size_t& pos) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte(pos);
+            // The 10th byte holds only bit 63
+            if (shift == 63 && b > 1) {
+                throw std::runtime_error("token stream: varint overflows 64 bits");
+            }
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("token stream: varint too long");
+    }
+};
+
+#endif // TOKEN_STREAM_H